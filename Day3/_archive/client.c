@@ -1,20 +1,120 @@
 // HTTP Client for testing the OpenMP Web Server
-// Build: gcc -O2 client.c -o client
+// Build: gcc -O2 -fopenmp client.c -o client
 // Run: ./client [host] [port] [path]
+//      ./client -s [-c connections] [-t threads] [-r rate] [-d seconds] [-o out.json] [host] [port] [path,...]
+//
+// Load mode (-s) is an open-loop generator: requests are scheduled at a
+// fixed total rate whatever the server does, spread over keep-alive
+// connections on several threads (one epoll loop per OpenMP thread, one
+// request in flight per connection). Latency is measured from the time a
+// request was *scheduled*, not from when a free connection finally sent it,
+// which corrects for coordinated omission: a stalled server shows up as
+// latency instead of as fewer samples; requests still unsent at the end
+// count with the time they waited. The uncorrected (service time)
+// histogram is reported alongside. With -r 0 each connection sends its next
+// request as soon as the previous answer arrives (closed loop).
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+#include <errno.h>
 #include <unistd.h>
 #include <sys/socket.h>
+#include <sys/epoll.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
+#include <netdb.h>
 #include <time.h>
+#include <omp.h>
 
 #define BUFFER_SIZE 4096
 #define DEFAULT_HOST "localhost"
 #define DEFAULT_PORT 8080
 #define DEFAULT_PATH "/"
 
+#define DEFAULT_CONNECTIONS 16
+#define DEFAULT_THREADS 2
+#define DEFAULT_RATE 1000       // requests per second, all threads
+#define DEFAULT_DURATION 10     // seconds
+#define MAX_PATHS 16
+#define DRAIN_NS 2000000000L    // wait for answers in flight after the run
+
+// Log-linear latency histogram in microseconds, HdrHistogram style: values
+// below 2*HIST_SUB are exact, above that each power of two is split into
+// HIST_SUB buckets (under 1.6% relative error). Covers more than an hour.
+#define HIST_SUB 64
+#define HIST_BUCKETS (HIST_SUB * 40)
+
+typedef struct {
+    long counts[HIST_BUCKETS];
+    long total;
+    long min, max;
+    double sum;
+} histogram;
+
+static int hist_index(long v) {
+    if (v < 2 * HIST_SUB) return (int)v;
+    int shift = 63 - __builtin_clzl(v) - 6;        // v >> shift in [64, 128)
+    int idx = HIST_SUB * shift + (int)(v >> shift);
+    return idx < HIST_BUCKETS ? idx : HIST_BUCKETS - 1;
+}
+
+// Largest value that lands in bucket idx
+static long hist_upper(int idx) {
+    if (idx < 2 * HIST_SUB) return idx;
+    int shift = idx / HIST_SUB - 1;
+    long m = idx % HIST_SUB + HIST_SUB;
+    return ((m + 1) << shift) - 1;
+}
+
+static void hist_record(histogram *h, long us) {
+    if (us < 0) us = 0;
+    h->counts[hist_index(us)]++;
+    if (h->total == 0 || us < h->min) h->min = us;
+    if (us > h->max) h->max = us;
+    h->total++;
+    h->sum += us;
+}
+
+static void hist_merge(histogram *into, const histogram *h) {
+    if (h->total == 0) return;
+    for (int i = 0; i < HIST_BUCKETS; ++i) into->counts[i] += h->counts[i];
+    if (into->total == 0 || h->min < into->min) into->min = h->min;
+    if (h->max > into->max) into->max = h->max;
+    into->total += h->total;
+    into->sum += h->sum;
+}
+
+static long hist_percentile(const histogram *h, double p) {
+    if (h->total == 0) return 0;
+    long rank = (long)(p / 100.0 * h->total + 0.5);
+    if (rank < 1) rank = 1;
+    long seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; ++i) {
+        seen += h->counts[i];
+        if (seen >= rank) return hist_upper(i) < h->max ? hist_upper(i) : h->max;
+    }
+    return h->max;
+}
+
+// Resolve host (name or dotted quad) to an IPv4 address
+static int resolve_host(const char* host, int port, struct sockaddr_in *addr) {
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, NULL, &hints, &res) != 0) {
+        fprintf(stderr, "Invalid address: %s\n", host);
+        return -1;
+    }
+    *addr = *(struct sockaddr_in *)res->ai_addr;
+    addr->sin_port = htons(port);
+    freeaddrinfo(res);
+    return 0;
+}
+
 // Send HTTP request and receive response
 static int send_request(const char* host, int port, const char* path) {
     int sock = socket(AF_INET, SOCK_STREAM, 0);
@@ -22,25 +122,21 @@ static int send_request(const char* host, int port, const char* path) {
         perror("socket");
         return -1;
     }
-    
+
     // Setup server address
     struct sockaddr_in server_addr;
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(port);
-    
-    if (inet_pton(AF_INET, host, &server_addr.sin_addr) <= 0) {
-        fprintf(stderr, "Invalid address: %s\n", host);
+    if (resolve_host(host, port, &server_addr) < 0) {
         close(sock);
         return -1;
     }
-    
+
     // Connect to server
     if (connect(sock, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
         perror("connect");
         close(sock);
         return -1;
     }
-    
+
     // Build HTTP request
     char request[BUFFER_SIZE];
     snprintf(request, sizeof(request),
@@ -49,7 +145,7 @@ static int send_request(const char* host, int port, const char* path) {
         "User-Agent: OpenMP-Client/1.0\r\n"
         "Connection: close\r\n"
         "\r\n", path, host, port);
-    
+
     // Send request
     ssize_t bytes_sent = send(sock, request, strlen(request), 0);
     if (bytes_sent < 0) {
@@ -57,30 +153,30 @@ static int send_request(const char* host, int port, const char* path) {
         close(sock);
         return -1;
     }
-    
+
     printf("Request sent (%zd bytes):\n%s\n", bytes_sent, request);
-    
+
     // Receive response
     char response[BUFFER_SIZE];
     ssize_t total_bytes = 0;
-    
+
     printf("Response received:\n");
     printf("==================\n");
-    
+
     while (1) {
         ssize_t bytes_received = recv(sock, response, sizeof(response) - 1, 0);
         if (bytes_received <= 0) {
             break;
         }
-        
+
         response[bytes_received] = '\0';
         printf("%s", response);
         total_bytes += bytes_received;
     }
-    
+
     printf("==================\n");
     printf("Total response size: %zd bytes\n", total_bytes);
-    
+
     close(sock);
     return 0;
 }
@@ -89,34 +185,34 @@ static int send_request(const char* host, int port, const char* path) {
 static void interactive_mode(const char* host, int port) {
     char line[256];
     char path[256];
-    
+
     printf("Interactive HTTP Client\n");
     printf("Connected to %s:%d\n", host, port);
     printf("Enter paths to request (or 'quit' to exit):\n");
     printf("Examples: /, /status, /connections, /test\n\n");
-    
+
     while (1) {
         printf("path> ");
         fflush(stdout);
-        
+
         if (!fgets(line, sizeof(line), stdin)) {
             break;
         }
-        
+
         // Remove newline
         line[strcspn(line, "\r\n")] = 0;
-        
+
         if (strcmp(line, "quit") == 0 || strcmp(line, "exit") == 0 || strcmp(line, "q") == 0) {
             break;
         }
-        
+
         if (strlen(line) == 0) {
             strcpy(path, "/");
         } else {
             strncpy(path, line, sizeof(path) - 1);
             path[sizeof(path) - 1] = '\0';
         }
-        
+
         printf("\n--- Requesting: %s ---\n", path);
         if (send_request(host, port, path) < 0) {
             printf("Request failed\n");
@@ -125,26 +221,352 @@ static void interactive_mode(const char* host, int port) {
     }
 }
 
-// Stress test mode - send multiple concurrent requests
-static void stress_test(const char* host, int port, int num_requests) {
-    printf("Stress test: sending %d requests to %s:%d\n", num_requests, host, port);
-    
-    const char* paths[] = {"/", "/status", "/connections", "/test"};
-    int num_paths = sizeof(paths) / sizeof(paths[0]);
-    
-    for (int i = 0; i < num_requests; ++i) {
-        const char* path = paths[i % num_paths];
-        printf("\n--- Request %d/%d: %s ---\n", i + 1, num_requests, path);
-        
-        if (send_request(host, port, path) < 0) {
-            printf("Request %d failed\n", i + 1);
+// ---------------------------------------------------------------------------
+// Load generator
+
+typedef struct {
+    struct sockaddr_in addr;
+    const char *host;
+    int port;
+    const char *paths[MAX_PATHS];
+    int num_paths;
+    int connections, threads;
+    double rate;                // requests/s over all threads, 0 = closed loop
+    double duration;
+} load_config;
+
+// Per-thread results, merged at the end
+typedef struct {
+    histogram corrected;        // from the scheduled send time
+    histogram uncorrected;      // from the actual send time
+    long sent, completed, errors, unsent, reconnects;
+    long status[6];             // by first digit, 1xx .. 5xx
+    long bytes;
+} load_stats;
+
+enum { LC_CLOSED, LC_CONNECTING, LC_IDLE, LC_BUSY };
+
+typedef struct {
+    int fd;
+    int state;
+    long intended, sent;        // ns timestamps of the request in flight
+    char head[BUFFER_SIZE];     // response header bytes
+    size_t head_len;
+    long body_left;             // -1 until the header is complete
+    int close_after;            // "Connection: close" or no Content-Length
+    int status;
+    int idle_pos;               // index in the thread's idle list, -1 if not in it
+} load_conn;
+
+// The idle list holds each LC_IDLE connection exactly once
+static void idle_push(load_conn *conns, int *idle, int *nidle, int idx) {
+    if (conns[idx].idle_pos >= 0) return;
+    conns[idx].idle_pos = *nidle;
+    idle[(*nidle)++] = idx;
+}
+
+static void idle_remove(load_conn *conns, int *idle, int *nidle, int idx) {
+    int pos = conns[idx].idle_pos;
+    if (pos < 0) return;
+    int last = idle[--*nidle];
+    idle[pos] = last;
+    conns[last].idle_pos = pos;
+    conns[idx].idle_pos = -1;
+}
+
+static long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static int lc_connect(int epfd, load_conn *lc, const load_config *cfg) {
+    lc->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (lc->fd < 0) return -1;
+    int one = 1;
+    setsockopt(lc->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (connect(lc->fd, (const struct sockaddr*)&cfg->addr, sizeof(cfg->addr)) < 0 && errno != EINPROGRESS) {
+        close(lc->fd);
+        return -1;
+    }
+    lc->state = LC_CONNECTING;
+    struct epoll_event ev = {.events = EPOLLOUT | EPOLLIN, .data.ptr = lc};
+    return epoll_ctl(epfd, EPOLL_CTL_ADD, lc->fd, &ev);
+}
+
+static void lc_close(load_conn *lc) {
+    if (lc->fd >= 0) close(lc->fd);
+    lc->fd = -1;
+    lc->state = LC_CLOSED;
+}
+
+static int lc_send(load_conn *lc, const load_config *cfg, long seq, long intended) {
+    char request[512];
+    int len = snprintf(request, sizeof(request),
+        "GET %s HTTP/1.1\r\n"
+        "Host: %s:%d\r\n"
+        "User-Agent: OpenMP-Client/1.0\r\n"
+        "\r\n", cfg->paths[seq % cfg->num_paths], cfg->host, cfg->port);
+
+    // Stamped before send(): on loopback the server may answer before
+    // send() returns. A request this small always fits an empty socket buffer.
+    lc->sent = now_ns();
+    if (send(lc->fd, request, len, MSG_NOSIGNAL) != len) return -1;
+    lc->state = LC_BUSY;
+    lc->intended = intended;
+    lc->head_len = 0;
+    lc->body_left = -1;
+    lc->close_after = 0;
+    return 0;
+}
+
+// Parse the response header once it is complete. Returns 1 when the header
+// is in, 0 if more bytes are needed.
+static int lc_parse_head(load_conn *lc, size_t *body_bytes) {
+    char *end = memmem(lc->head, lc->head_len, "\r\n\r\n", 4);
+    if (!end) return 0;
+    size_t head = end + 4 - lc->head;
+    *body_bytes = lc->head_len - head;
+    *end = '\0';
+
+    lc->status = atoi(lc->head + 9);   // "HTTP/1.1 200"
+    const char *cl = strcasestr(lc->head, "\r\nContent-Length:");
+    const char *conn = strcasestr(lc->head, "\r\nConnection:");
+    lc->close_after = conn && strncasecmp(conn + 13 + strspn(conn + 13, " "), "close", 5) == 0;
+    if (cl) {
+        lc->body_left = strtol(cl + 17, NULL, 10);
+    } else {
+        lc->body_left = 0;
+        lc->close_after = 1;            // body runs to end of stream; not counted
+    }
+    return 1;
+}
+
+// Read what the socket has. Returns 1 when the response is complete, 0 if
+// more is expected, -1 on error or end of stream.
+static int lc_read(load_conn *lc, load_stats *st) {
+    for (;;) {
+        char sink[16384];
+        char *dst = lc->body_left < 0 ? lc->head + lc->head_len : sink;
+        size_t room = lc->body_left < 0 ? sizeof(lc->head) - 1 - lc->head_len : sizeof(sink);
+        if (room == 0) return -1;       // header too large
+
+        ssize_t n = recv(lc->fd, dst, room, 0);
+        if (n == 0) return -1;
+        if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : (errno == EINTR ? 0 : -1);
+        st->bytes += n;
+
+        if (lc->body_left < 0) {
+            lc->head_len += n;
+            size_t body_bytes;
+            if (!lc_parse_head(lc, &body_bytes)) continue;
+            lc->body_left -= body_bytes;
+        } else {
+            lc->body_left -= n;
         }
-        
-        // Small delay between requests
-        usleep(100000); // 100ms
+        if (lc->body_left <= 0) return 1;
     }
-    
-    printf("\nStress test completed\n");
+}
+
+static void load_thread(const load_config *cfg, int tid, long start, load_stats *st) {
+    int nconn = cfg->connections / cfg->threads + (tid < cfg->connections % cfg->threads);
+    if (nconn == 0) return;
+    load_conn *conns = calloc(nconn, sizeof(*conns));
+    int *idle = malloc(nconn * sizeof(int));
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (!conns || !idle || epfd < 0) {
+        free(conns);
+        free(idle);
+        st->errors++;
+        return;
+    }
+
+    int nidle = 0;
+    for (int i = 0; i < nconn; ++i) {
+        conns[i].fd = -1;
+        conns[i].idle_pos = -1;
+        if (lc_connect(epfd, &conns[i], cfg) < 0) {
+            lc_close(&conns[i]);
+            st->errors++;
+        }
+    }
+
+    // This thread's share of the schedule: request k is due at
+    // start + (k + tid / threads) * interval
+    double thread_rate = cfg->rate / cfg->threads;
+    long interval = thread_rate > 0 ? (long)(1e9 / thread_rate) : 0;
+    long offset = interval * tid / cfg->threads;
+    long end = start + (long)(cfg->duration * 1e9);
+    long seq = 0;
+    long in_flight = 0;
+
+    struct epoll_event events[256];
+    for (;;) {
+        long now = now_ns();
+        int sending = now < end;
+        if (!sending && (in_flight == 0 || now >= end + DRAIN_NS)) break;
+
+        // Send every request that is due, on free connections
+        while (sending && nidle > 0) {
+            long due = interval ? start + offset + seq * interval : now;
+            if (due > now) break;
+            int idx = idle[nidle - 1];
+            load_conn *lc = &conns[idx];
+            idle_remove(conns, idle, &nidle, idx);
+            if (lc_send(lc, cfg, seq, due) < 0) {
+                st->errors++;
+                lc_close(lc);
+                st->reconnects++;
+                if (lc_connect(epfd, lc, cfg) < 0) lc_close(lc);
+                continue;
+            }
+            seq++;
+            st->sent++;
+            in_flight++;
+        }
+
+        // Sleep until the next request is due or a connection wakes up
+        int timeout = 100;
+        if (sending && nidle > 0 && interval) {
+            long wait = start + offset + seq * interval - now_ns();
+            timeout = wait <= 0 ? 0 : (int)(wait / 1000000);
+        }
+        int n = epoll_wait(epfd, events, 256, timeout);
+        for (int e = 0; e < n; ++e) {
+            load_conn *lc = events[e].data.ptr;
+            int idx = (int)(lc - conns);
+
+            if (lc->state == LC_CONNECTING) {
+                int err = 0;
+                socklen_t len = sizeof(err);
+                getsockopt(lc->fd, SOL_SOCKET, SO_ERROR, &err, &len);
+                if (err) {
+                    st->errors++;
+                    lc_close(lc);
+                    st->reconnects++;
+                    if (lc_connect(epfd, lc, cfg) < 0) lc_close(lc);
+                    continue;
+                }
+                struct epoll_event ev = {.events = EPOLLIN, .data.ptr = lc};
+                epoll_ctl(epfd, EPOLL_CTL_MOD, lc->fd, &ev);
+                lc->state = LC_IDLE;
+                idle_push(conns, idle, &nidle, idx);
+                continue;
+            }
+
+            if (lc->state != LC_BUSY) {
+                // Server closed an idle connection: reconnect
+                idle_remove(conns, idle, &nidle, idx);
+                lc_close(lc);
+                st->reconnects++;
+                if (lc_connect(epfd, lc, cfg) < 0) lc_close(lc);
+                continue;
+            }
+
+            int r = lc_read(lc, st);
+            if (r == 0) continue;
+            in_flight--;
+            if (r < 0) {
+                st->errors++;
+            } else {
+                long done = now_ns();
+                hist_record(&st->corrected, (done - lc->intended) / 1000);
+                hist_record(&st->uncorrected, (done - lc->sent) / 1000);
+                st->completed++;
+                if (lc->status >= 100 && lc->status < 600) st->status[lc->status / 100]++;
+            }
+
+            if (r < 0 || lc->close_after) {
+                lc_close(lc);
+                st->reconnects++;
+                if (lc_connect(epfd, lc, cfg) < 0) lc_close(lc);
+            } else {
+                lc->state = LC_IDLE;
+                idle_push(conns, idle, &nidle, idx);
+            }
+        }
+    }
+
+    // Requests that were due but never got a connection are latency the
+    // server caused; count them, and record each as waiting from its due
+    // time to the end of the run, so a stall shows up in the tail
+    if (interval) {
+        long due_total = (end - start - offset + interval - 1) / interval;
+        for (long k = seq; k < due_total; ++k) {
+            hist_record(&st->corrected, (end - (start + offset + k * interval)) / 1000);
+            st->unsent++;
+        }
+    }
+    st->errors += in_flight;            // never answered
+
+    for (int i = 0; i < nconn; ++i) lc_close(&conns[i]);
+    close(epfd);
+    free(conns);
+    free(idle);
+}
+
+static void print_latency(FILE *out, const char *name, const histogram *h, const char *tail) {
+    fprintf(out,
+        "    \"%s\": {\"min\": %ld, \"mean\": %.1f, \"p50\": %ld, \"p90\": %ld, \"p99\": %ld, "
+        "\"p99.9\": %ld, \"max\": %ld}%s\n",
+        name, h->min, h->total ? h->sum / h->total : 0.0, hist_percentile(h, 50), hist_percentile(h, 90),
+        hist_percentile(h, 99), hist_percentile(h, 99.9), h->max, tail);
+}
+
+static int load_test(load_config *cfg, const char *json_path) {
+    if (resolve_host(cfg->host, cfg->port, &cfg->addr) < 0) return 1;
+
+    load_stats *stats = calloc(cfg->threads, sizeof(*stats));
+    load_stats total;
+    memset(&total, 0, sizeof(total));
+    if (!stats) return 1;
+
+    fprintf(stderr, "Load test: %s:%d, %d connections on %d threads, %s, %.0f s\n",
+            cfg->host, cfg->port, cfg->connections, cfg->threads,
+            cfg->rate > 0 ? "open loop" : "closed loop", cfg->duration);
+
+    long start = now_ns() + 100000000L; // let connections come up first
+    #pragma omp parallel num_threads(cfg->threads)
+    load_thread(cfg, omp_get_thread_num(), start, &stats[omp_get_thread_num()]);
+    double elapsed = cfg->duration;
+
+    for (int t = 0; t < cfg->threads; ++t) {
+        hist_merge(&total.corrected, &stats[t].corrected);
+        hist_merge(&total.uncorrected, &stats[t].uncorrected);
+        total.sent += stats[t].sent;
+        total.completed += stats[t].completed;
+        total.errors += stats[t].errors;
+        total.unsent += stats[t].unsent;
+        total.reconnects += stats[t].reconnects;
+        total.bytes += stats[t].bytes;
+        for (int s = 0; s < 6; ++s) total.status[s] += stats[t].status[s];
+    }
+    free(stats);
+
+    FILE *out = json_path ? fopen(json_path, "w") : stdout;
+    if (!out) {
+        perror(json_path);
+        return 1;
+    }
+    fprintf(out, "{\n");
+    fprintf(out, "  \"target\": \"%s:%d\",\n  \"paths\": [", cfg->host, cfg->port);
+    for (int i = 0; i < cfg->num_paths; ++i) fprintf(out, "%s\"%s\"", i ? ", " : "", cfg->paths[i]);
+    fprintf(out, "],\n");
+    fprintf(out, "  \"connections\": %d,\n  \"threads\": %d,\n  \"target_rate\": %.1f,\n  \"duration_s\": %.1f,\n",
+            cfg->connections, cfg->threads, cfg->rate, cfg->duration);
+    fprintf(out, "  \"requests\": {\"sent\": %ld, \"completed\": %ld, \"errors\": %ld, \"unsent\": %ld, "
+                 "\"reconnects\": %ld},\n",
+            total.sent, total.completed, total.errors, total.unsent, total.reconnects);
+    fprintf(out, "  \"status\": {\"1xx\": %ld, \"2xx\": %ld, \"3xx\": %ld, \"4xx\": %ld, \"5xx\": %ld},\n",
+            total.status[1], total.status[2], total.status[3], total.status[4], total.status[5]);
+    fprintf(out, "  \"throughput_rps\": %.1f,\n  \"bytes_received\": %ld,\n",
+            total.completed / elapsed, total.bytes);
+    fprintf(out, "  \"latency_us\": {\n");
+    print_latency(out, "corrected", &total.corrected, ",");
+    print_latency(out, "uncorrected", &total.uncorrected, "");
+    fprintf(out, "  }\n}\n");
+    if (json_path) fclose(out);
+    return total.completed > 0 ? 0 : 1;
 }
 
 int main(int argc, char* argv[]) {
@@ -153,35 +575,54 @@ int main(int argc, char* argv[]) {
     const char* path = DEFAULT_PATH;
     int interactive = 0;
     int stress = 0;
-    int num_requests = 10;
-    
+    const char* json_path = NULL;
+    load_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.connections = DEFAULT_CONNECTIONS;
+    cfg.threads = DEFAULT_THREADS;
+    cfg.rate = DEFAULT_RATE;
+    cfg.duration = DEFAULT_DURATION;
+    int positional = 0;
+
     // Parse command line arguments
     for (int i = 1; i < argc; ++i) {
         if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
             printf("Usage: %s [options] [host] [port] [path]\n", argv[0]);
             printf("Options:\n");
             printf("  -i, --interactive    Interactive mode\n");
-            printf("  -s, --stress [num]   Stress test with num requests (default: 10)\n");
+            printf("  -s, --stress         Load test, JSON report (path may be a comma list)\n");
+            printf("  -c <n>               Load test connections (default: %d)\n", DEFAULT_CONNECTIONS);
+            printf("  -t <n>               Load test threads (default: %d)\n", DEFAULT_THREADS);
+            printf("  -r <req/s>           Total request rate, 0 = closed loop (default: %d)\n", DEFAULT_RATE);
+            printf("  -d <seconds>         Load test duration (default: %d)\n", DEFAULT_DURATION);
+            printf("  -o <file>            Write the JSON report to a file (default: stdout)\n");
             printf("  -h, --help          Show this help\n");
             printf("\nExamples:\n");
             printf("  %s                           # Connect to localhost:8080/\n", argv[0]);
             printf("  %s localhost 8080 /status    # Get server status\n", argv[0]);
             printf("  %s -i                        # Interactive mode\n", argv[0]);
-            printf("  %s -s 20                     # Stress test with 20 requests\n", argv[0]);
+            printf("  %s -s -r 20000 -c 64 -t 4    # 20k req/s over 64 connections\n", argv[0]);
+            printf("  %s -s localhost 8080 /,/test # Alternate two routes\n", argv[0]);
             return 0;
         } else if (strcmp(argv[i], "-i") == 0 || strcmp(argv[i], "--interactive") == 0) {
             interactive = 1;
         } else if (strcmp(argv[i], "-s") == 0 || strcmp(argv[i], "--stress") == 0) {
             stress = 1;
-            if (i + 1 < argc && argv[i + 1][0] != '-') {
-                num_requests = atoi(argv[++i]);
-                if (num_requests <= 0) num_requests = 10;
-            }
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            cfg.connections = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            cfg.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            cfg.rate = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            cfg.duration = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
         } else if (argv[i][0] != '-') {
             // Positional arguments: host, port, path
-            if (strcmp(host, DEFAULT_HOST) == 0) {
+            if (positional == 0) {
                 host = argv[i];
-            } else if (port == DEFAULT_PORT) {
+            } else if (positional == 1) {
                 port = atoi(argv[i]);
                 if (port <= 0 || port > 65535) {
                     fprintf(stderr, "Invalid port: %s\n", argv[i]);
@@ -190,22 +631,39 @@ int main(int argc, char* argv[]) {
             } else {
                 path = argv[i];
             }
+            positional++;
         }
     }
-    
+
+    if (stress) {
+        if (cfg.threads < 1 || cfg.connections < cfg.threads || cfg.rate < 0 || cfg.duration <= 0) {
+            fprintf(stderr, "Need threads >= 1, connections >= threads, rate >= 0, duration > 0\n");
+            return 1;
+        }
+        cfg.host = host;
+        cfg.port = port;
+        char *paths = strdup(path), *saveptr;
+        for (char *p = strtok_r(paths, ",", &saveptr); p && cfg.num_paths < MAX_PATHS;
+             p = strtok_r(NULL, ",", &saveptr)) {
+            cfg.paths[cfg.num_paths++] = p;
+        }
+        if (cfg.num_paths == 0) cfg.paths[cfg.num_paths++] = DEFAULT_PATH;
+        int rc = load_test(&cfg, json_path);
+        free(paths);
+        return rc;
+    }
+
     printf("HTTP Client for OpenMP Web Server\n");
     printf("Target: %s:%d%s\n\n", host, port, path);
-    
+
     if (interactive) {
         interactive_mode(host, port);
-    } else if (stress) {
-        stress_test(host, port, num_requests);
     } else {
         // Single request
         if (send_request(host, port, path) < 0) {
             return 1;
         }
     }
-    
+
     return 0;
 }
@@ -1,54 +1,707 @@
 // Real HTTP Web Server with OpenMP Task Management
 // Build: gcc -O2 -fopenmp webserver.c -o webserver
-// Run: OMP_NUM_THREADS=4 ./webserver [port]
+// Run: OMP_NUM_THREADS=4 OMP_MAX_TASK_PRIORITY=2 ./webserver
+//       [-a acceptors] [-c max_conn] [-w compute_threads] [-q queue_depth] [-t idle_seconds] [-r root] [-v] [port]
+//
+// I/O is event driven (Linux epoll): the first `acceptors` threads of the
+// team each run an event loop with their own SO_REUSEPORT listening socket,
+// accept and read with non-blocking sockets, and hand every complete request
+// to the OpenMP task pool. The remaining threads wait at the end of the
+// parallel region and execute those tasks. A slow client only costs a
+// connection slot and a buffer, never a worker thread.
+//
+// Connection sockets are registered with EPOLLONESHOT: after an event fires,
+// exactly one thread (the loop, or the task it created) owns the connection
+// until it re-arms it.
+//
+// Connections are persistent (HTTP/1.1 keep-alive, or HTTP/1.0 with
+// "Connection: keep-alive"). The parser is incremental: bytes accumulate in
+// the connection buffer across reads, and a task answers every complete
+// request it finds there in order (pipelining), batching the responses
+// into one send. Connections that wait on the client for longer than the
+// idle timeout are shut down by their event loop. Only the event loop frees
+// a connection; a task that wants to close one shuts the socket down and
+// lets the loop see the end of stream.
+//
+// Admission is bounded: at most `queue_depth` request tasks are queued or
+// running. Each route has a priority, used both as the task priority()
+// and to shed load early: a route at priority p is admitted only while the
+// queue is below (p + 1) / PRIO_LEVELS of its depth, so heavy low-priority
+// routes are turned away first. Rejected requests get an immediate 503 with
+// Retry-After from the event loop itself, without ever becoming a task.
+// The depth defaults to a few requests per I/O worker and always stays
+// below the point where the OpenMP runtime stops deferring tasks and the
+// event loop would run requests itself.
+//
+// CPU-heavy routes run on a separate compute pool (a nested team) and come
+// back to their event loop through an eventfd (see "Compute pool").
+//
+// Files under the document root are served as /static/<name>, from an LRU
+// cache of pre-rendered responses or with sendfile (see "Static files").
+//
+// /metrics exposes request counts, latency histograms per route and
+// per-thread busy time in the Prometheus text format. Threads count into
+// their own padded blocks, added up only when scraped (see "Metrics").
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+#include <errno.h>
 #include <unistd.h>
 #include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <pthread.h>
+#include <sys/resource.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <time.h>
 #include <signal.h>
 #include <omp.h>
 
-#define MAX_CONN 128
+#define DEFAULT_MAX_CONN 65536
 #define BUFFER_SIZE 4096
 #define DEFAULT_PORT 8080
+#define LISTEN_BACKLOG 4096 // capped by net.core.somaxconn
+#define MAX_EVENTS 256
+#define MAX_ACCEPTORS 64
+#define CONN_LIST_MAX 200   // connections listed on /connections
+#define IDLE_TIMEOUT 5      // seconds a connection may wait on the client
+#define MAX_PIPELINE 32     // requests answered per task before flushing
+#define OUT_CHUNKS 64       // queued output pieces, at most 2 per response
+#define STATIC_PREFIX "/static/"
+#define DEFAULT_ROOT "static"
+#define CACHE_BYTES (64 << 20)      // response cache budget
+#define CACHE_MAX_FILE (1 << 20)    // larger files bypass the cache
+#define CACHE_BUCKETS 1024
+#define CACHE_CHECK_MS 1000         // how often a cached file is stat()ed
+#define QUEUE_PER_WORKER 8          // default request tasks per I/O worker
+#define TASK_THROTTLE 64            // libgomp runs new tasks inline past this many per thread
+#define PRIO_LEVELS 3               // route priorities 0 (shed first) .. 2
+#define RETRY_AFTER 1               // seconds, sent with 503
+#define COMPUTE_THREADS 2           // nested compute team, 0 = run inline
+#define COMPUTE_QUEUE 256           // compute jobs queued or running
+#define STR_(x) #x
+#define STR(x) STR_(x)
 
-// Global connection management arrays
-static int conn_id[MAX_CONN];        // Connection IDs
-static int conn_alive[MAX_CONN];     // Connection status: 1=alive, 0=stopping
-static int conn_in_use[MAX_CONN];    // Slot allocation status
+// Global server state
 static int next_id = 1;              // Next connection ID
-static int server_socket = -1;       // Main server socket
 static volatile int server_running = 1; // Server shutdown flag
+static int idle_timeout_ms = IDLE_TIMEOUT * 1000;
+static const char *doc_root = DEFAULT_ROOT; // directory behind /static/
 
-// HTTP response templates
-static const char* HTTP_200_OK = 
-    "HTTP/1.1 200 OK\r\n"
-    "Content-Type: text/html; charset=utf-8\r\n"
-    "Connection: close\r\n"
-    "\r\n";
+// Thread roles
+static int compute_threads = COMPUTE_THREADS;
+static int io_workers = 0;           // team threads left to run request tasks
+static int compute_efd = -1;         // semaphore eventfd: compute jobs queued
+static int compute_pending = 0;      // compute jobs reserved or queued, not yet taken
 
-static const char* HTTP_404_NOT_FOUND = 
-    "HTTP/1.1 404 Not Found\r\n"
-    "Content-Type: text/html; charset=utf-8\r\n"
-    "Connection: close\r\n"
-    "\r\n";
+// Admission control
+static int queue_depth = 0;          // 0 until set by -q or from the team size
+static int queued = 0;               // request tasks queued or running
+
+// Response cache size (see "Static files")
+static size_t cache_bytes = 0;
+static int cache_entries = 0;
+
+// One per event loop thread
+struct loop {
+    int index;
+    int epfd;
+    int listen_fd;
+    int slot_hint;      // bitmap word where the last slot was found
+    int wake_fd;        // eventfd: compute jobs finished
+    struct compute_job *done; // finished jobs, pushed by compute threads
+};
+
+static char wake_tag;   // epoll data of the wake eventfd
+
+static struct loop loops[MAX_ACCEPTORS];
+static int num_loops = 1;
+
+// Per-connection state, owned by one thread at a time (EPOLLONESHOT)
+struct conn {
+    int fd;
+    int id;
+    int slot;
+    struct loop *loop;
+    unsigned waiting;   // EPOLLIN or EPOLLOUT, what the connection is parked on
+    long idle_since;    // ms timestamp when parked, 0 while a thread owns it
+    int keep_alive;     // cleared by a request that ends the connection
+    int eof;            // the client half-closed
+    int closing;        // shut down on our side, draining until the client closes
+    long read_ns;       // when the last read completed the buffered requests
+    size_t in_len;      // bytes buffered, possibly several pipelined requests
+    size_t scanned;     // bytes already searched for the end of the headers
+    char in[BUFFER_SIZE];
+    char *out;          // generated pages and headers of queued responses
+    size_t out_len, out_cap;
+    struct out_chunk {
+        enum { CHUNK_BUF, CHUNK_CACHE, CHUNK_FILE } kind;
+        struct cache_entry *entry;     // CHUNK_CACHE: referenced entry
+        int fd;                        // CHUNK_FILE: open file
+        size_t off, len;               // unsent range of the buffer, entry or file
+    } chunks[OUT_CHUNKS];
+    int chunk_head, chunk_count;
+    struct compute_job *pending_job; // set when a request went to the compute pool
+};
+
+// A parsed request; strings point into the connection buffer
+struct http_request {
+    char *method;
+    char *path;
+    int keep_alive;
+};
+
+// ---------------------------------------------------------------------------
+// Connection slots
+//
+// One bit per slot in a bitmap of 64-bit words. Claiming a slot is a
+// compare-and-swap that sets the lowest zero bit of a word; freeing is an
+// atomic AND. Each event loop starts its search at its own hint, so loops
+// rarely race for the same word. Everything the status pages show about a
+// slot (connection id, owning loop, alive flag) is packed into one word and
+// published with a single store. Walking the set bits visits active slots
+// only, at one load per 64 slots. The table size is set at run time (-c).
+
+#define SLOT_INFO(id, loop, alive) ((uint64_t)(uint32_t)(id) << 32 | (uint64_t)(loop) << 1 | (alive))
+#define INFO_ID(v)    ((int)((v) >> 32))
+#define INFO_LOOP(v)  ((int)((v) >> 1 & 0x7fff))
+#define INFO_ALIVE(v) ((int)((v) & 1))
+
+static int max_conn = DEFAULT_MAX_CONN;
+static int slot_words;                // max_conn / 64
+static uint64_t *slot_used;           // the bitmap
+static uint64_t *slot_info;           // SLOT_INFO() of each used slot
+static struct conn **conn_table;      // connection of each used slot
+
+static int slots_init(int n) {
+    slot_words = (n + 63) / 64;
+    max_conn = slot_words * 64;
+    slot_used = calloc(slot_words, sizeof(*slot_used));
+    slot_info = calloc(max_conn, sizeof(*slot_info));
+    conn_table = calloc(max_conn, sizeof(*conn_table));
+    return slot_used && slot_info && conn_table ? 0 : -1;
+}
+
+// Claim a free slot, or -1 if the table is full
+static int slot_claim(struct loop *lp) {
+    for (int k = 0; k < slot_words; ++k) {
+        int w = (lp->slot_hint + k) % slot_words;
+        uint64_t cur = __atomic_load_n(&slot_used[w], __ATOMIC_RELAXED);
+        while (cur != ~0ULL) {
+            uint64_t bit = ~cur & (cur + 1);   // lowest zero bit
+            if (__atomic_compare_exchange_n(&slot_used[w], &cur, cur | bit, 1,
+                                            __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+                lp->slot_hint = w;
+                return w * 64 + __builtin_ctzll(bit);
+            }
+            // cur now holds the word's new value; retry within it
+        }
+    }
+    return -1;
+}
+
+static void slot_free(int slot) {
+    __atomic_fetch_and(&slot_used[slot / 64], ~(1ULL << (slot % 64)), __ATOMIC_RELEASE);
+}
 
-static const char* HTTP_500_ERROR = 
-    "HTTP/1.1 500 Internal Server Error\r\n"
-    "Content-Type: text/html; charset=utf-8\r\n"
-    "Connection: close\r\n"
+// Bits of the used slots in word w
+static uint64_t slot_word(int w) {
+    return __atomic_load_n(&slot_used[w], __ATOMIC_ACQUIRE);
+}
+
+// HTTP response header template: status, reason, type, body length,
+// connection, extra header lines
+static const char* HTTP_HEADER =
+    "HTTP/1.1 %d %s\r\n"
+    "Content-Type: %s\r\n"
+    "Content-Length: %zu\r\n"
+    "Connection: %s\r\n"
+    "%s"
     "\r\n";
 
-// Signal handler for graceful shutdown
+static const char* status_reason(int status) {
+    switch (status) {
+    case 200: return "OK";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 503: return "Service Unavailable";
+    default:  return "Internal Server Error";
+    }
+}
+
+static long now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000;
+}
+
+static long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+// ---------------------------------------------------------------------------
+// Logging
+//
+// Each thread appends fixed-size records to its own single-producer ring:
+// a raw timestamp and the message text, with no lock and no system call.
+// A background thread drains all rings every LOG_FLUSH_MS, orders the batch
+// by time, formats the timestamps and writes it with one write(2). When a
+// ring is full the record is dropped and counted, never waited for.
+// Levels above LOG_LEVEL (-DLOG_LEVEL=...) compile to nothing; debug
+// records are additionally gated by -v at run time.
+
+#define LVL_ERROR 0
+#define LVL_WARN  1
+#define LVL_INFO  2
+#define LVL_DEBUG 3
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LVL_DEBUG
+#endif
+
+#define LOG_RING 1024        // records per thread, a power of two
+#define LOG_MSG 112          // message bytes per record
+#define LOG_MAX_THREADS 256
+#define LOG_FLUSH_MS 50
+#define LOG_BATCH 8192       // records formatted per write
+
+#define LOG(level, ...) do { \
+        if ((level) <= LOG_LEVEL && (level) <= log_threshold) log_write(level, __VA_ARGS__); \
+    } while (0)
+#define LOG_ERROR(...) LOG(LVL_ERROR, __VA_ARGS__)
+#define LOG_WARN(...)  LOG(LVL_WARN, __VA_ARGS__)
+#define LOG_INFO(...)  LOG(LVL_INFO, __VA_ARGS__)
+#define LOG_DEBUG(...) LOG(LVL_DEBUG, __VA_ARGS__)
+
+struct log_rec {
+    long ts_ns;              // CLOCK_REALTIME, formatted by the flusher
+    int level;
+    int thread;
+    char msg[LOG_MSG];
+};
+
+struct log_ring {
+    unsigned long head __attribute__((aligned(64)));  // written by the owner
+    unsigned long tail __attribute__((aligned(64)));  // written by the flusher
+    long dropped;
+    struct log_rec recs[LOG_RING];
+};
+
+static int log_threshold = LVL_INFO;
+static struct log_ring *log_rings[LOG_MAX_THREADS];
+static int log_nrings = 0;
+static __thread struct log_ring *my_ring;
+static __thread int my_ring_index;
+static pthread_t log_thread;
+static volatile int log_running = 0;
+
+static void log_write(int level, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static void log_write(int level, const char *fmt, ...) {
+    if (!my_ring) {
+        // First record of this thread: register a ring
+        int i = __atomic_fetch_add(&log_nrings, 1, __ATOMIC_RELAXED);
+        struct log_ring *r = i < LOG_MAX_THREADS ? calloc(1, sizeof(*r)) : NULL;
+        if (!r) return;
+        my_ring = r;
+        my_ring_index = i;
+        __atomic_store_n(&log_rings[i], r, __ATOMIC_RELEASE);
+    }
+
+    struct log_ring *r = my_ring;
+    unsigned long head = r->head;
+    if (head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) == LOG_RING) {
+        __atomic_fetch_add(&r->dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    struct log_rec *rec = &r->recs[head % LOG_RING];
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    rec->ts_ns = ts.tv_sec * 1000000000L + ts.tv_nsec;
+    rec->level = level;
+    rec->thread = my_ring_index;
+
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(rec->msg, sizeof(rec->msg), fmt, ap);
+    va_end(ap);
+
+    __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+}
+
+static int rec_cmp(const void *a, const void *b) {
+    const struct log_rec *x = a, *y = b;
+    return (x->ts_ns > y->ts_ns) - (x->ts_ns < y->ts_ns);
+}
+
+static void write_all(int fd, const char *p, size_t n) {
+    while (n > 0) {
+        ssize_t w = write(fd, p, n);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return;
+        p += w;
+        n -= w;
+    }
+}
+
+// Drain every ring once; returns the number of records written
+static int log_drain(struct log_rec *batch, char *text, size_t text_size) {
+    static const char *names[] = {"ERROR", "WARN", "INFO", "DEBUG"};
+    static time_t last_sec = -1;
+    static char sec_text[16];
+    int n = 0;
+
+    int nrings = __atomic_load_n(&log_nrings, __ATOMIC_ACQUIRE);
+    if (nrings > LOG_MAX_THREADS) nrings = LOG_MAX_THREADS;
+    for (int i = 0; i < nrings; ++i) {
+        struct log_ring *r = __atomic_load_n(&log_rings[i], __ATOMIC_ACQUIRE);
+        if (!r) continue;
+        unsigned long tail = r->tail;
+        unsigned long head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+        while (tail != head && n < LOG_BATCH) batch[n++] = r->recs[tail++ % LOG_RING];
+        __atomic_store_n(&r->tail, tail, __ATOMIC_RELEASE);
+
+        long dropped = __atomic_exchange_n(&r->dropped, 0, __ATOMIC_RELAXED);
+        if (dropped && n < LOG_BATCH) {
+            struct log_rec *d = &batch[n++];
+            d->ts_ns = n > 1 ? batch[n - 2].ts_ns : 0;
+            d->level = LVL_WARN;
+            d->thread = i;
+            snprintf(d->msg, sizeof(d->msg), "%ld log records dropped", dropped);
+        }
+    }
+    if (n == 0) return 0;
+
+    qsort(batch, n, sizeof(*batch), rec_cmp);
+
+    size_t len = 0;
+    for (int k = 0; k < n; ++k) {
+        time_t sec = batch[k].ts_ns / 1000000000L;
+        if (sec != last_sec) {
+            struct tm tm;
+            localtime_r(&sec, &tm);
+            strftime(sec_text, sizeof(sec_text), "%H:%M:%S", &tm);
+            last_sec = sec;
+        }
+        len += snprintf(text + len, text_size - len, "[%s.%03ld] %-5s t%02d %s\n", sec_text,
+                        batch[k].ts_ns / 1000000 % 1000, names[batch[k].level], batch[k].thread,
+                        batch[k].msg);
+    }
+    write_all(STDOUT_FILENO, text, len);
+    return n;
+}
+
+static void *log_flusher(void *arg) {
+    (void)arg;
+    struct log_rec *batch = malloc(LOG_BATCH * sizeof(*batch));
+    size_t text_size = LOG_BATCH * (LOG_MSG + 32);
+    char *text = malloc(text_size);
+    if (!batch || !text) return NULL;
+
+    struct timespec pause = {0, LOG_FLUSH_MS * 1000000L};
+    while (log_running) {
+        if (log_drain(batch, text, text_size) < LOG_BATCH) nanosleep(&pause, NULL);
+    }
+    while (log_drain(batch, text, text_size) > 0) {}   // whatever is left
+
+    free(batch);
+    free(text);
+    return NULL;
+}
+
+static void log_start(void) {
+    fflush(stdout);                  // banner first
+    log_running = 1;
+    if (pthread_create(&log_thread, NULL, log_flusher, NULL) != 0) log_running = 0;
+}
+
+static void log_stop(void) {
+    if (!log_running) return;
+    log_running = 0;
+    pthread_join(log_thread, NULL);
+}
+
+// ---------------------------------------------------------------------------
+// Metrics
+//
+// Every thread counts into its own cache-line aligned block: plain relaxed
+// stores by the owner, no shared line and no locked instruction on the
+// request path. A scrape (/metrics, /status) walks all blocks and adds them
+// up; it may see one thread's counters a few increments apart, never torn.
+// Latency is measured from the read that completed a request to its
+// response being queued, per route, in a fixed set of histogram buckets.
+
+#define METRICS_MAX_THREADS 256
+#define METRICS_SIZE (64 << 10)     // rendered /metrics page
+
+enum { ROUTE_INDEX, ROUTE_STATUS, ROUTE_CONNECTIONS, ROUTE_METRICS, ROUTE_TEST, ROUTE_STATIC,
+       ROUTE_OTHER, ROUTES };
+static const char *route_names[ROUTES] = {
+    "/", "/status", "/connections", "/metrics", "/test", STATIC_PREFIX, "other"
+};
+
+// Status codes the server sends; anything else counts as the last one
+static const int status_codes[] = {200, 400, 404, 405, 503, 500};
+#define CODES ((int)(sizeof(status_codes) / sizeof(status_codes[0])))
+
+// Histogram upper bounds, seconds and nanoseconds; one more bucket for +Inf
+#define LATENCY_BUCKETS 14
+static const char *latency_le[LATENCY_BUCKETS] = {
+    "0.0001", "0.00025", "0.0005", "0.001", "0.0025", "0.005", "0.01",
+    "0.025", "0.05", "0.1", "0.25", "0.5", "1", "2.5"
+};
+static const long latency_le_ns[LATENCY_BUCKETS] = {
+    100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000,
+    25000000, 50000000, 100000000, 250000000, 500000000, 1000000000, 2500000000
+};
+
+enum { ROLE_WORKER, ROLE_LOOP, ROLE_COMPUTE };
+static const char *role_names[] = {"worker", "loop", "compute"};
+
+struct thread_stats {
+    long requests[ROUTES][CODES];
+    long latency[ROUTES][LATENCY_BUCKETS + 1]; // per bucket, not cumulative
+    long latency_ns[ROUTES];
+    long sent_bytes;
+    long accepted, refused, closed;            // connections
+    long shed;                                 // requests answered 503 by admission
+    long cache_hits, cache_misses;
+    long busy_ns;                              // time spent handling events and requests
+} __attribute__((aligned(64)));
+
+static struct thread_stats thread_stats[METRICS_MAX_THREADS];
+static int thread_roles[METRICS_MAX_THREADS];
+static int stats_nthreads = 0;
+static struct thread_stats stats_spill; // shared by threads past the limit; may lose counts
+static __thread struct thread_stats *my_stats;
+static __thread int busy_depth;
+
+// The calling thread's block; the first call registers it under `role`
+static struct thread_stats *stats_register(int role) {
+    if (!my_stats) {
+        int i = __atomic_fetch_add(&stats_nthreads, 1, __ATOMIC_RELAXED);
+        if (i < METRICS_MAX_THREADS) {
+            __atomic_store_n(&thread_roles[i], role, __ATOMIC_RELAXED);
+            my_stats = &thread_stats[i];
+        } else {
+            my_stats = &stats_spill;
+        }
+    }
+    return my_stats;
+}
+
+// Only the owner writes a counter, so a load and a store are enough
+#define STAT_ADD(field, n) do { \
+        struct thread_stats *s_ = stats_register(ROLE_WORKER); \
+        __atomic_store_n(&s_->field, __atomic_load_n(&s_->field, __ATOMIC_RELAXED) + (n), \
+                         __ATOMIC_RELAXED); \
+    } while (0)
+
+static int route_index(const char *path) {
+    if (!path) return ROUTE_OTHER;
+    if (strcmp(path, "/") == 0 || strcmp(path, "/index.html") == 0) return ROUTE_INDEX;
+    if (strcmp(path, "/status") == 0) return ROUTE_STATUS;
+    if (strcmp(path, "/connections") == 0) return ROUTE_CONNECTIONS;
+    if (strcmp(path, "/metrics") == 0) return ROUTE_METRICS;
+    if (strcmp(path, "/test") == 0) return ROUTE_TEST;
+    if (strncmp(path, STATIC_PREFIX, strlen(STATIC_PREFIX)) == 0) return ROUTE_STATIC;
+    return ROUTE_OTHER;
+}
+
+// Count a response queued for `path`; `start_ns` is when the request was read
+static void stats_request(const char *path, int status, long start_ns) {
+    int route = route_index(path), code = 0, bucket = 0;
+    while (code < CODES - 1 && status_codes[code] != status) code++;
+    long ns = now_ns() - start_ns;
+    while (bucket < LATENCY_BUCKETS && ns > latency_le_ns[bucket]) bucket++;
+
+    STAT_ADD(requests[route][code], 1);
+    STAT_ADD(latency[route][bucket], 1);
+    STAT_ADD(latency_ns[route], ns);
+}
+
+// Busy time brackets; nested brackets (a task run inline by its event
+// loop) count once
+static long busy_begin(void) {
+    return busy_depth++ ? 0 : now_ns();
+}
+
+static void busy_end(long start) {
+    if (--busy_depth == 0) STAT_ADD(busy_ns, now_ns() - start);
+}
+
+static long stat_load(const long *p) {
+    return __atomic_load_n(p, __ATOMIC_RELAXED);
+}
+
+static void stats_add(struct thread_stats *sum, const struct thread_stats *s) {
+    for (int r = 0; r < ROUTES; ++r) {
+        for (int k = 0; k < CODES; ++k) sum->requests[r][k] += stat_load(&s->requests[r][k]);
+        for (int b = 0; b <= LATENCY_BUCKETS; ++b) sum->latency[r][b] += stat_load(&s->latency[r][b]);
+        sum->latency_ns[r] += stat_load(&s->latency_ns[r]);
+    }
+    sum->sent_bytes += stat_load(&s->sent_bytes);
+    sum->accepted += stat_load(&s->accepted);
+    sum->refused += stat_load(&s->refused);
+    sum->closed += stat_load(&s->closed);
+    sum->shed += stat_load(&s->shed);
+    sum->cache_hits += stat_load(&s->cache_hits);
+    sum->cache_misses += stat_load(&s->cache_misses);
+    sum->busy_ns += stat_load(&s->busy_ns);
+}
+
+static int stats_threads(void) {
+    int n = __atomic_load_n(&stats_nthreads, __ATOMIC_RELAXED);
+    return n < METRICS_MAX_THREADS ? n : METRICS_MAX_THREADS;
+}
+
+// Add up every thread's counters
+static void stats_sum(struct thread_stats *sum) {
+    memset(sum, 0, sizeof(*sum));
+    for (int t = 0; t < stats_threads(); ++t) stats_add(sum, &thread_stats[t]);
+    stats_add(sum, &stats_spill);
+}
+
+static void emit(char *out, size_t size, size_t *len, const char *fmt, ...) __attribute__((format(printf, 4, 5)));
+
+// Append to a page, dropping whatever does not fit
+static void emit(char *out, size_t size, size_t *len, const char *fmt, ...) {
+    if (*len + 1 >= size) return;
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(out + *len, size - *len, fmt, ap);
+    va_end(ap);
+    if (n > 0) *len = *len + n < size ? *len + n : size - 1;
+}
+
+// Render the Prometheus text exposition; returns its length
+static size_t render_metrics(char *out, size_t size) {
+    struct thread_stats sum;
+    stats_sum(&sum);
+    size_t len = 0;
+
+    int depth, computing, entries;
+    size_t bytes;
+    #pragma omp atomic read
+    depth = queued;
+    #pragma omp atomic read
+    computing = compute_pending;
+    #pragma omp critical (cache)
+    {
+        entries = cache_entries;
+        bytes = cache_bytes;
+    }
+
+    emit(out, size, &len,
+         "# HELP webserver_http_requests_total Responses queued, by route and status code.\n"
+         "# TYPE webserver_http_requests_total counter\n");
+    for (int r = 0; r < ROUTES; ++r) {
+        for (int k = 0; k < CODES; ++k) {
+            if (sum.requests[r][k] == 0) continue;
+            emit(out, size, &len, "webserver_http_requests_total{route=\"%s\",code=\"%d\"} %ld\n",
+                 route_names[r], status_codes[k], sum.requests[r][k]);
+        }
+    }
+
+    emit(out, size, &len,
+         "# HELP webserver_http_request_duration_seconds Time from reading a request to queueing its response.\n"
+         "# TYPE webserver_http_request_duration_seconds histogram\n");
+    for (int r = 0; r < ROUTES; ++r) {
+        long count = 0;
+        for (int b = 0; b <= LATENCY_BUCKETS; ++b) count += sum.latency[r][b];
+        if (count == 0) continue;
+
+        long cumulative = 0;
+        for (int b = 0; b < LATENCY_BUCKETS; ++b) {
+            cumulative += sum.latency[r][b];
+            emit(out, size, &len, "webserver_http_request_duration_seconds_bucket{route=\"%s\",le=\"%s\"} %ld\n",
+                 route_names[r], latency_le[b], cumulative);
+        }
+        emit(out, size, &len,
+             "webserver_http_request_duration_seconds_bucket{route=\"%s\",le=\"+Inf\"} %ld\n"
+             "webserver_http_request_duration_seconds_sum{route=\"%s\"} %.9f\n"
+             "webserver_http_request_duration_seconds_count{route=\"%s\"} %ld\n",
+             route_names[r], count, route_names[r], sum.latency_ns[r] / 1e9, route_names[r], count);
+    }
+
+    emit(out, size, &len,
+         "# HELP webserver_sent_bytes_total Bytes written to client sockets.\n"
+         "# TYPE webserver_sent_bytes_total counter\n"
+         "webserver_sent_bytes_total %ld\n"
+         "# HELP webserver_connections_accepted_total Connections accepted.\n"
+         "# TYPE webserver_connections_accepted_total counter\n"
+         "webserver_connections_accepted_total %ld\n"
+         "# HELP webserver_connections_refused_total Connections closed at once, no free slot.\n"
+         "# TYPE webserver_connections_refused_total counter\n"
+         "webserver_connections_refused_total %ld\n"
+         "# HELP webserver_connections_active Open connections.\n"
+         "# TYPE webserver_connections_active gauge\n"
+         "webserver_connections_active %ld\n"
+         "# HELP webserver_request_queue_depth Request tasks queued or running.\n"
+         "# TYPE webserver_request_queue_depth gauge\n"
+         "webserver_request_queue_depth %d\n"
+         "# HELP webserver_request_queue_capacity Request tasks admitted at most.\n"
+         "# TYPE webserver_request_queue_capacity gauge\n"
+         "webserver_request_queue_capacity %d\n"
+         "# HELP webserver_shed_requests_total Requests answered 503 by admission control.\n"
+         "# TYPE webserver_shed_requests_total counter\n"
+         "webserver_shed_requests_total %ld\n"
+         "# HELP webserver_compute_queue_depth Compute jobs waiting for a compute thread.\n"
+         "# TYPE webserver_compute_queue_depth gauge\n"
+         "webserver_compute_queue_depth %d\n"
+         "# HELP webserver_cache_hits_total Static files answered from the response cache.\n"
+         "# TYPE webserver_cache_hits_total counter\n"
+         "webserver_cache_hits_total %ld\n"
+         "# HELP webserver_cache_misses_total Static files opened.\n"
+         "# TYPE webserver_cache_misses_total counter\n"
+         "webserver_cache_misses_total %ld\n"
+         "# HELP webserver_cache_entries Files in the response cache.\n"
+         "# TYPE webserver_cache_entries gauge\n"
+         "webserver_cache_entries %d\n"
+         "# HELP webserver_cache_bytes Bytes held by the response cache.\n"
+         "# TYPE webserver_cache_bytes gauge\n"
+         "webserver_cache_bytes %zu\n",
+         sum.sent_bytes, sum.accepted, sum.refused, sum.accepted - sum.closed,
+         depth, queue_depth, sum.shed, computing,
+         sum.cache_hits, sum.cache_misses, entries, bytes);
+
+    emit(out, size, &len,
+         "# HELP webserver_thread_busy_seconds_total Time spent handling events, requests and jobs.\n"
+         "# TYPE webserver_thread_busy_seconds_total counter\n");
+    for (int t = 0; t < stats_threads(); ++t) {
+        int role = __atomic_load_n(&thread_roles[t], __ATOMIC_RELAXED);
+        emit(out, size, &len, "webserver_thread_busy_seconds_total{thread=\"%d\",role=\"%s\"} %.6f\n",
+             t, role_names[role], stat_load(&thread_stats[t].busy_ns) / 1e9);
+    }
+    return len;
+}
+
+// Signal handler for graceful shutdown: the event loops notice within one
+// epoll_wait timeout
+static volatile sig_atomic_t stop_signal = 0;
+
 static void signal_handler(int sig) {
-    printf("\n[server] Received signal %d, shutting down...\n", sig);
+    stop_signal = sig;
     server_running = 0;
-    if (server_socket != -1) {
-        close(server_socket);
+
+    // One wake-up per compute thread; write() is async-signal-safe
+    if (compute_efd >= 0 && compute_threads > 0) {
+        uint64_t n = compute_threads;
+        ssize_t r = write(compute_efd, &n, sizeof(n));
+        (void)r;
     }
 }
 
@@ -58,8 +711,8 @@ static void simulate_work(int cycles) {
     for (int i = 0; i < cycles; ++i) s += i;
 }
 
-// Generate HTML response based on request path
-static void generate_response(const char* path, char* response, size_t max_size) {
+// Generate HTML response based on request path; returns the HTTP status
+static int generate_response(const char* path, char* response, size_t max_size) {
     if (strcmp(path, "/") == 0 || strcmp(path, "/index.html") == 0) {
         snprintf(response, max_size,
             "<!DOCTYPE html>\n"
@@ -72,56 +725,75 @@ static void generate_response(const char* path, char* response, size_t max_size)
             "<ul>\n"
             "<li><a href=\"/status\">Server Status</a></li>\n"
             "<li><a href=\"/connections\">Active Connections</a></li>\n"
+            "<li><a href=\"/metrics\">Metrics</a></li>\n"
             "<li><a href=\"/test\">Test Page</a></li>\n"
             "</ul>\n"
             "</body></html>\n",
             time(NULL), omp_get_num_threads(), omp_get_max_threads());
     } else if (strcmp(path, "/status") == 0) {
-        int active_conns = 0;
-        // Count active connections using atomic operations for thread safety
-        for (int i = 0; i < MAX_CONN; ++i) {
-            int used, alive;
-            #pragma omp atomic read
-            used = conn_in_use[i];
-            if (used) {
-                #pragma omp atomic read
-                alive = conn_alive[i];
-                if (alive) active_conns++;
-            }
+        struct thread_stats sum;
+        stats_sum(&sum);
+        long active = sum.accepted - sum.closed, shed = sum.shed;
+        long hits = sum.cache_hits, misses = sum.cache_misses;
+
+        int depth, computing;
+        #pragma omp atomic read
+        depth = queued;
+        #pragma omp atomic read
+        computing = compute_pending;
+
+        int entries;
+        size_t bytes;
+        #pragma omp critical (cache)
+        {
+            entries = cache_entries;
+            bytes = cache_bytes;
         }
-        
+
         snprintf(response, max_size,
             "<!DOCTYPE html>\n"
             "<html><head><title>Server Status</title></head>\n"
             "<body>\n"
             "<h1>Server Status</h1>\n"
             "<p>Server running: %s</p>\n"
-            "<p>Active connections: %d</p>\n"
+            "<p>Active connections: %ld</p>\n"
             "<p>Max connections: %d</p>\n"
             "<p>OpenMP threads: %d/%d</p>\n"
+            "<p>Event loops: %d</p>\n"
+            "<p>Request queue: %d/%d, shed: %ld</p>\n"
+            "<p>Compute pool: %d threads, %d/%d jobs waiting</p>\n"
+            "<p>Static cache: %d files, %zu KB, %ld hits, %ld misses</p>\n"
             "<p>Server time: %ld</p>\n"
             "<a href=\"/\">Back to Home</a>\n"
             "</body></html>\n",
-            server_running ? "Yes" : "No", active_conns, MAX_CONN,
-            omp_get_num_threads(), omp_get_max_threads(), time(NULL));
+            server_running ? "Yes" : "No", active, max_conn,
+            omp_get_num_threads(), omp_get_max_threads(), num_loops,
+            depth, queue_depth, shed,
+            compute_threads, computing, COMPUTE_QUEUE,
+            entries, bytes / 1024, hits, misses, time(NULL));
     } else if (strcmp(path, "/connections") == 0) {
-        char conn_list[2048] = "";
-        for (int i = 0; i < MAX_CONN; ++i) {
-            int used, alive, id;
-            #pragma omp atomic read
-            used = conn_in_use[i];
-            if (used) {
-                #pragma omp atomic read
-                id = conn_id[i];
-                #pragma omp atomic read
-                alive = conn_alive[i];
-                char temp[64];
-                snprintf(temp, sizeof(temp), "<li>Connection %d (slot %d) - %s</li>\n", 
-                        id, i, alive ? "Active" : "Stopping");
-                strcat(conn_list, temp);
+        char conn_list[BUFFER_SIZE] = "";
+        size_t len = 0;
+        int listed = 0, more = 0;
+        for (int w = 0; w < slot_words; ++w) {
+            for (uint64_t bits = slot_word(w); bits; bits &= bits - 1) {
+                int i = w * 64 + __builtin_ctzll(bits);
+                uint64_t info = __atomic_load_n(&slot_info[i], __ATOMIC_RELAXED);
+                if (info == 0) continue;       // claimed, not yet published
+                if (listed == CONN_LIST_MAX || len + 64 >= sizeof(conn_list)) {
+                    more++;
+                    continue;
+                }
+                len += snprintf(conn_list + len, sizeof(conn_list) - len,
+                        "<li>Connection %d (slot %d) - %s</li>\n",
+                        INFO_ID(info), i, INFO_ALIVE(info) ? "Active" : "Stopping");
+                listed++;
             }
         }
-        
+        if (more) {
+            snprintf(conn_list + len, sizeof(conn_list) - len, "<li>... and %d more</li>\n", more);
+        }
+
         snprintf(response, max_size,
             "<!DOCTYPE html>\n"
             "<html><head><title>Active Connections</title></head>\n"
@@ -152,234 +824,1203 @@ static void generate_response(const char* path, char* response, size_t max_size)
             "<p>The requested page '%s' was not found.</p>\n"
             "<a href=\"/\">Back to Home</a>\n"
             "</body></html>\n", path);
+        return 404;
     }
+    return 200;
 }
 
-// Handle HTTP request and send response
-static void handle_http_request(int client_socket, int conn_id, int slot_idx) {
-    char buffer[BUFFER_SIZE];
-    char response[BUFFER_SIZE * 2];
-    char http_response[BUFFER_SIZE * 3];
-    
-    printf("[conn %02d] Handling request (slot %d, tid %d)\n", 
-           conn_id, slot_idx, omp_get_thread_num());
-    
-    // Read HTTP request
-    ssize_t bytes_read = recv(client_socket, buffer, sizeof(buffer) - 1, 0);
-    if (bytes_read <= 0) {
-        printf("[conn %02d] Failed to read request\n", conn_id);
-        return;
+// ---------------------------------------------------------------------------
+// Compute pool
+//
+// CPU-heavy routes (/test) do not run on the I/O task pool. The request task
+// parses them into a job and gives up the connection; one thread of the
+// main team opens a nested parallel region whose threads take jobs from a
+// bounded queue, sleeping on a semaphore eventfd while it is empty. A
+// finished job goes onto its event loop's lock-free completion stack and
+// wakes the loop through the loop's eventfd; the loop queues the response
+// and sends it. The cheap routes keep the I/O workers to themselves.
+
+struct compute_job {
+    struct conn *c;
+    char path[256];
+    int keep_alive, head_only;
+    int status;
+    char body[BUFFER_SIZE * 2];
+    struct compute_job *next;   // completion stack link
+};
+
+static struct compute_job *compute_queue[COMPUTE_QUEUE];
+static int compute_head = 0, compute_count = 0;
+
+static int is_compute_route(const char *path) {
+    return strcmp(path, "/test") == 0;
+}
+
+// Reserve a queue place; fails when the pool is saturated
+static int compute_reserve(void) {
+    int n;
+    #pragma omp atomic capture
+    n = ++compute_pending;
+    if (n <= COMPUTE_QUEUE) return 1;
+    #pragma omp atomic
+    compute_pending--;
+    return 0;
+}
+
+static void compute_cancel(void) {
+    #pragma omp atomic
+    compute_pending--;
+}
+
+// Queue a reserved job; from here on the job owns its connection
+static void compute_submit(struct compute_job *job) {
+    #pragma omp critical (compute)
+    {
+        compute_queue[(compute_head + compute_count) % COMPUTE_QUEUE] = job;
+        compute_count++;
+    }
+    uint64_t one = 1;
+    if (write(compute_efd, &one, sizeof(one)) < 0) LOG_ERROR("compute eventfd: %m");
+}
+
+static struct compute_job *compute_pop(void) {
+    struct compute_job *job = NULL;
+    #pragma omp critical (compute)
+    if (compute_count > 0) {
+        job = compute_queue[compute_head];
+        compute_head = (compute_head + 1) % COMPUTE_QUEUE;
+        compute_count--;
+    }
+    if (job) {
+        #pragma omp atomic
+        compute_pending--;
+    }
+    return job;
+}
+
+// Hand a finished job back to the connection's event loop
+static void compute_complete(struct compute_job *job) {
+    struct loop *lp = job->c->loop;
+    job->next = __atomic_load_n(&lp->done, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&lp->done, &job->next, job, 1,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {}
+    uint64_t one = 1;
+    if (write(lp->wake_fd, &one, sizeof(one)) < 0) LOG_ERROR("loop eventfd: %m");
+}
+
+static void compute_worker(void) {
+    stats_register(ROLE_COMPUTE);
+    for (;;) {
+        uint64_t token;
+        if (read(compute_efd, &token, sizeof(token)) < 0 && errno != EINTR) break;
+
+        struct compute_job *job = compute_pop();
+        if (!job) {
+            if (!server_running) break;  // the shutdown token
+            continue;
+        }
+        long busy = busy_begin();
+        job->status = generate_response(job->path, job->body, sizeof(job->body));
+        compute_complete(job);
+        busy_end(busy);
+    }
+}
+
+static void compute_pool(void) {
+    LOG_INFO("compute pool: %d threads", compute_threads);
+
+    // NOTE: nested parallel region - a team of its own for CPU-heavy
+    // handlers, so they never occupy the threads running I/O tasks
+    #pragma omp parallel num_threads(compute_threads)
+    compute_worker();
+}
+
+static void out_reset(struct conn *c);
+
+// Close the connection and free its slot - event loop thread only
+static void close_conn(struct conn *c) {
+    close(c->fd);
+    out_reset(c);
+
+    // Unpublish, then hand the slot back
+    __atomic_store_n(&slot_info[c->slot], 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&conn_table[c->slot], NULL, __ATOMIC_RELAXED);
+    slot_free(c->slot);
+    STAT_ADD(closed, 1);
+
+    LOG_DEBUG("conn %d closed", c->id);
+    free(c->out);
+    free(c);
+}
+
+// Hand the connection back to its event loop, waiting for `events`. The
+// caller must not touch the connection afterwards.
+static void rearm(struct conn *c, unsigned events) {
+    struct epoll_event ev;
+    ev.events = events | EPOLLONESHOT;
+    ev.data.ptr = c;
+    c->waiting = events;
+
+    #pragma omp atomic write
+    c->idle_since = now_ms();
+
+    if (epoll_ctl(c->loop->epfd, EPOLL_CTL_MOD, c->fd, &ev) < 0) {
+        LOG_ERROR("conn %d: epoll_ctl: %m", c->id);
+    }
+}
+
+// Stop talking to the client. With SHUT_WR the loop waits for the client
+// to close its side, so a response is never cut off by a reset.
+static void shutdown_conn(struct conn *c, int how) {
+    shutdown(c->fd, how);
+    c->closing = 1;
+    __atomic_store_n(&slot_info[c->slot], SLOT_INFO(c->id, c->loop->index, 0), __ATOMIC_RELAXED);
+    rearm(c, EPOLLIN);
+}
+
+// Length of the first request in the buffer once it is complete (headers
+// plus Content-Length body), 0 while more bytes are needed, -1 if it is
+// malformed or can never fit. Only bytes not seen before are searched.
+static long request_length(struct conn *c) {
+    size_t from = c->scanned > 3 ? c->scanned - 3 : 0;
+    char *end = memmem(c->in + from, c->in_len - from, "\r\n\r\n", 4);
+    if (!end) {
+        c->scanned = c->in_len;
+        return c->in_len == sizeof(c->in) - 1 ? -1 : 0;
+    }
+    c->scanned = end - c->in;
+
+    size_t head = end + 4 - c->in;
+    long body = 0;
+    for (char *line = memchr(c->in, '\n', head); line && line + 1 < end; line = strchr(line + 1, '\n')) {
+        if (strncasecmp(line + 1, "Content-Length:", 15) == 0) {
+            body = strtol(line + 16, NULL, 10);
+        } else if (strncasecmp(line + 1, "Transfer-Encoding:", 18) == 0) {
+            return -1;                 // chunked bodies are not supported
+        }
+    }
+    if (body < 0 || head + body > sizeof(c->in) - 1) return -1;
+    if (head + body > c->in_len) return 0;
+    return (long)(head + body);
+}
+
+// Parse the request line and the Connection header in place
+static int parse_request(struct conn *c, struct http_request *req) {
+    char *line_end = strstr(c->in, "\r\n");
+    if (!line_end) return -1;
+    char *conn_hdr = strcasestr(line_end, "\r\nConnection:");
+    char *headers_end = strstr(line_end, "\r\n\r\n");
+    *line_end = '\0';
+
+    char* saveptr;
+    req->method = strtok_r(c->in, " ", &saveptr);
+    req->path = strtok_r(NULL, " ", &saveptr);
+    char* version = strtok_r(NULL, " ", &saveptr);
+    if (!req->method || !req->path || !version || strncmp(version, "HTTP/1.", 7) != 0) {
+        return -1;
+    }
+
+    // HTTP/1.1 defaults to persistent connections, HTTP/1.0 does not
+    req->keep_alive = strcmp(version, "HTTP/1.0") != 0;
+    if (conn_hdr && conn_hdr < headers_end) {
+        const char *v = conn_hdr + 13;
+        while (*v == ' ' || *v == '\t') v++;
+        if (strncasecmp(v, "close", 5) == 0) req->keep_alive = 0;
+        else if (strncasecmp(v, "keep-alive", 10) == 0) req->keep_alive = 1;
+    }
+    return 0;
+}
+
+// Drop a handled request from the front of the buffer
+static void consume(struct conn *c, size_t len) {
+    memmove(c->in, c->in + len, c->in_len - len);
+    c->in_len -= len;
+    c->in[c->in_len] = '\0';
+    c->scanned = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Static files and the response cache
+//
+// /static/<name> serves <root>/<name>. Files up to CACHE_MAX_FILE are kept
+// as one pre-rendered buffer (keep-alive header + body) in an LRU cache keyed
+// by file path, so a hit is queued by reference and sent with a single
+// writev. An entry is checked against the file's mtime and size at most
+// every CACHE_CHECK_MS. Larger files go out with sendfile. Entries are
+// reference counted: eviction never frees a buffer a response still sends.
+
+struct cache_entry {
+    char *key;                         // file path
+    char *data;                        // header + body
+    size_t header_len, len;
+    struct timespec mtime;
+    off_t size;
+    long checked_ms;                   // last time the file was stat()ed
+    int refs;                          // the cache's own + responses in flight
+    int cached;                        // still in the table
+    struct cache_entry *prev, *next;   // LRU list, most recent first
+    struct cache_entry *hnext;         // hash chain
+};
+
+static struct cache_entry *cache_table[CACHE_BUCKETS];
+static struct cache_entry *lru_head, *lru_tail;
+
+static unsigned hash_key(const char *s) {
+    unsigned h = 2166136261u;          // FNV-1a
+    while (*s) h = (h ^ (unsigned char)*s++) * 16777619u;
+    return h % CACHE_BUCKETS;
+}
+
+static const char *content_type(const char *path) {
+    static const char *types[][2] = {
+        {".html", "text/html; charset=utf-8"}, {".css", "text/css"},
+        {".js", "application/javascript"},     {".json", "application/json"},
+        {".txt", "text/plain; charset=utf-8"}, {".svg", "image/svg+xml"},
+        {".png", "image/png"},                 {".jpg", "image/jpeg"},
+    };
+    const char *dot = strrchr(path, '.');
+    for (size_t i = 0; dot && i < sizeof(types) / sizeof(types[0]); ++i) {
+        if (strcmp(dot, types[i][0]) == 0) return types[i][1];
+    }
+    return "application/octet-stream";
+}
+
+// Drop a reference; the last one frees the entry (inside critical(cache))
+static void cache_put_locked(struct cache_entry *e) {
+    if (--e->refs == 0) {
+        free(e->key);
+        free(e->data);
+        free(e);
+    }
+}
+
+static void cache_release(struct cache_entry *e) {
+    #pragma omp critical (cache)
+    cache_put_locked(e);
+}
+
+// Take the entry out of the table and the LRU list (inside critical(cache))
+static void cache_unlink_locked(struct cache_entry *e) {
+    if (!e->cached) return;
+    struct cache_entry **p = &cache_table[hash_key(e->key)];
+    while (*p != e) p = &(*p)->hnext;
+    *p = e->hnext;
+
+    if (e->prev) e->prev->next = e->next; else lru_head = e->next;
+    if (e->next) e->next->prev = e->prev; else lru_tail = e->prev;
+
+    e->cached = 0;
+    cache_bytes -= e->len;
+    cache_entries--;
+    cache_put_locked(e);
+}
+
+// Look up a file and take a reference, or NULL on a miss or a stale entry
+static struct cache_entry *cache_get(const char *key) {
+    struct cache_entry *e = NULL;
+    long now = now_ms();
+    int check = 0;
+
+    #pragma omp critical (cache)
+    {
+        for (e = cache_table[hash_key(key)]; e && strcmp(e->key, key) != 0; e = e->hnext) {}
+        if (e) {
+            e->refs++;
+            if (e != lru_head) {       // move to the front of the LRU list
+                e->prev->next = e->next;
+                if (e->next) e->next->prev = e->prev; else lru_tail = e->prev;
+                e->prev = NULL;
+                e->next = lru_head;
+                lru_head->prev = e;
+                lru_head = e;
+            }
+            check = now - e->checked_ms >= CACHE_CHECK_MS;
+        }
+    }
+    if (!e) return NULL;
+
+    if (check) {
+        struct stat st;
+        int fresh = stat(key, &st) == 0 && st.st_size == e->size &&
+                    st.st_mtim.tv_sec == e->mtime.tv_sec && st.st_mtim.tv_nsec == e->mtime.tv_nsec;
+        #pragma omp critical (cache)
+        {
+            if (fresh) e->checked_ms = now;
+            else cache_unlink_locked(e);
+            if (!fresh) cache_put_locked(e);
+        }
+        if (!fresh) return NULL;
     }
-    
-    buffer[bytes_read] = '\0';
-    
-    // Parse HTTP request to extract path
-    char* method = strtok(buffer, " ");
-    char* path = strtok(NULL, " ");
-    
-    if (!method || !path) {
-        printf("[conn %02d] Invalid HTTP request\n", conn_id);
+
+    STAT_ADD(cache_hits, 1);
+    return e;
+}
+
+// Read a small file into a new entry and publish it. Returns it with a
+// reference for the caller, or NULL if reading failed.
+static struct cache_entry *cache_load(const char *key, int fd, const struct stat *st) {
+    char header[256];
+    int header_len = snprintf(header, sizeof(header), HTTP_HEADER, 200, status_reason(200),
+                              content_type(key), (size_t)st->st_size, "keep-alive", "");
+
+    struct cache_entry *e = calloc(1, sizeof(*e));
+    char *data = malloc(header_len + st->st_size);
+    char *k = strdup(key);
+    if (!e || !data || !k) {
+        free(e);
+        free(data);
+        free(k);
+        return NULL;
+    }
+    memcpy(data, header, header_len);
+    for (off_t got = 0; got < st->st_size;) {
+        ssize_t n = pread(fd, data + header_len + got, st->st_size - got, got);
+        if (n <= 0) {
+            free(e);
+            free(data);
+            free(k);
+            return NULL;
+        }
+        got += n;
+    }
+
+    e->key = k;
+    e->data = data;
+    e->header_len = header_len;
+    e->len = header_len + st->st_size;
+    e->mtime = st->st_mtim;
+    e->size = st->st_size;
+    e->checked_ms = now_ms();
+    e->refs = 2;                       // the cache's and the caller's
+    e->cached = 1;
+
+    #pragma omp critical (cache)
+    {
+        // Another task may have loaded the same file meanwhile; newest wins
+        unsigned h = hash_key(k);
+        for (struct cache_entry *old = cache_table[h]; old; old = old->hnext) {
+            if (strcmp(old->key, k) == 0) {
+                cache_unlink_locked(old);
+                break;
+            }
+        }
+        e->hnext = cache_table[h];
+        cache_table[h] = e;
+        e->next = lru_head;
+        if (lru_head) lru_head->prev = e; else lru_tail = e;
+        lru_head = e;
+        cache_bytes += e->len;
+        cache_entries++;
+
+        while (cache_bytes > CACHE_BYTES && lru_tail != e) cache_unlink_locked(lru_tail);
+    }
+    return e;
+}
+
+// ---------------------------------------------------------------------------
+// Output queue
+//
+// A connection's pending output is a list of chunks sent in order: bytes in
+// the connection's own buffer (generated pages and headers), slices of cache
+// entries, and file ranges. Runs of memory chunks go out with one writev,
+// file ranges with sendfile.
+
+// Room for `size` more bytes at the end of the connection buffer
+static char *out_reserve(struct conn *c, size_t size) {
+    if (c->out_len + size > c->out_cap) {
+        size_t cap = c->out_cap ? c->out_cap : BUFFER_SIZE;
+        while (cap < c->out_len + size) cap *= 2;
+        char *out = realloc(c->out, cap);
+        if (!out) return NULL;
+        c->out = out;
+        c->out_cap = cap;
+    }
+    return c->out + c->out_len;
+}
+
+static void queue_chunk(struct conn *c, int kind, struct cache_entry *e, int fd, size_t off, size_t len) {
+    struct out_chunk *k = &c->chunks[c->chunk_count++];
+    k->kind = kind;
+    k->entry = e;
+    k->fd = fd;
+    k->off = off;
+    k->len = len;
+}
+
+// Render a response header into the connection buffer and queue it
+static int queue_header(struct conn *c, int status, const char *type, size_t body_len, int keep_alive) {
+    char *h = out_reserve(c, 256);
+    if (!h) return -1;
+    int n = snprintf(h, 256, HTTP_HEADER, status, status_reason(status), type, body_len,
+                     keep_alive ? "keep-alive" : "close",
+                     status == 503 ? "Retry-After: " STR(RETRY_AFTER) "\r\n" : "");
+    queue_chunk(c, CHUNK_BUF, NULL, -1, c->out_len, n);
+    c->out_len += n;
+    return 0;
+}
+
+static void release_chunk(struct out_chunk *k) {
+    if (k->kind == CHUNK_FILE) close(k->fd);
+    else if (k->kind == CHUNK_CACHE) cache_release(k->entry);
+}
+
+// Drop everything queued, sent or not
+static void out_reset(struct conn *c) {
+    for (int i = c->chunk_head; i < c->chunk_count; ++i) release_chunk(&c->chunks[i]);
+    c->chunk_head = c->chunk_count = 0;
+    c->out_len = 0;
+}
+
+// Send as much of the pending output as the socket takes. Returns 1 when
+// everything is sent, 0 when the rest must wait for EPOLLOUT, -1 on error.
+static int flush_out(struct conn *c) {
+    while (c->chunk_head < c->chunk_count) {
+        struct out_chunk *k = &c->chunks[c->chunk_head];
+        ssize_t n;
+
+        if (k->kind == CHUNK_FILE) {
+            off_t off = k->off;
+            n = sendfile(c->fd, k->fd, &off, k->len);
+        } else {
+            struct iovec iov[OUT_CHUNKS];
+            int cnt = 0;
+            for (int i = c->chunk_head; i < c->chunk_count && c->chunks[i].kind != CHUNK_FILE; ++i) {
+                struct out_chunk *m = &c->chunks[i];
+                iov[cnt].iov_base = (m->kind == CHUNK_BUF ? c->out : m->entry->data) + m->off;
+                iov[cnt].iov_len = m->len;
+                cnt++;
+            }
+            n = writev(c->fd, iov, cnt);
+        }
+
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+        if (n <= 0) return -1;
+        STAT_ADD(sent_bytes, n);
+
+        // Advance over what went out
+        while (n > 0) {
+            k = &c->chunks[c->chunk_head];
+            size_t step = (size_t)n < k->len ? (size_t)n : k->len;
+            k->off += step;
+            k->len -= step;
+            n -= step;
+            if (k->len == 0) {
+                release_chunk(k);
+                c->chunk_head++;
+            }
+        }
+    }
+    c->chunk_head = c->chunk_count = 0;
+    c->out_len = 0;
+    return 1;
+}
+
+// Queue a file under /static/; returns the HTTP status
+static int serve_static(struct conn *c, const struct http_request *req, int head_only) {
+    char key[PATH_MAX];
+    const char *name = req->path + strlen(STATIC_PREFIX);
+    size_t name_len = strcspn(name, "?");
+
+    if (name_len == 0 || strstr(name, "..") ||
+        snprintf(key, sizeof(key), "%s/%.*s", doc_root, (int)name_len, name) >= (int)sizeof(key)) {
+        return 404;
+    }
+
+    struct cache_entry *e = cache_get(key);
+    if (!e) {
+        int fd = open(key, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return 404;
+        struct stat st;
+        if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode)) {
+            close(fd);
+            return 404;
+        }
+
+        STAT_ADD(cache_misses, 1);
+
+        if (st.st_size <= CACHE_MAX_FILE) {
+            e = cache_load(key, fd, &st);
+        }
+        if (!e) {
+            // Too large to cache: header from the buffer, body by sendfile
+            if (queue_header(c, 200, content_type(key), st.st_size, req->keep_alive) < 0) {
+                close(fd);
+                return 500;
+            }
+            if (head_only || st.st_size == 0) close(fd);
+            else queue_chunk(c, CHUNK_FILE, NULL, fd, 0, st.st_size);
+            return 200;
+        }
+        close(fd);
+    }
+
+    if (req->keep_alive) {
+        // The pre-rendered header fits as is
+        queue_chunk(c, CHUNK_CACHE, e, -1, 0, head_only ? e->header_len : e->len);
+    } else if (queue_header(c, 200, content_type(key), e->size, 0) < 0) {
+        cache_release(e);
+        return 500;
+    } else if (head_only || e->size == 0) {
+        cache_release(e);
+    } else {
+        queue_chunk(c, CHUNK_CACHE, e, -1, e->header_len, e->size);
+    }
+    return 200;
+}
+
+// Render /metrics into the connection buffer and queue it; returns the HTTP
+// status
+static int serve_metrics(struct conn *c, const struct http_request *req, int head_only) {
+    size_t body_off = c->out_len;
+    char *body = out_reserve(c, METRICS_SIZE);
+    if (!body) return 500;
+    size_t body_len = render_metrics(body, METRICS_SIZE);
+    c->out_len += body_len;
+
+    if (queue_header(c, 200, "text/plain; version=0.0.4; charset=utf-8", body_len, req->keep_alive) < 0) {
+        return 500;
+    }
+    if (!head_only) queue_chunk(c, CHUNK_BUF, NULL, -1, body_off, body_len);
+    return 200;
+}
+
+// Queue the header for a page already rendered into the connection buffer,
+// then the page itself
+static void queue_body(struct conn *c, int status, size_t body_off, size_t body_len,
+                       int keep_alive, int head_only) {
+    if (queue_header(c, status, "text/html; charset=utf-8", body_len, keep_alive) < 0) {
+        c->keep_alive = 0;
+    } else if (!head_only) {
+        queue_chunk(c, CHUNK_BUF, NULL, -1, body_off, body_len);
+    }
+}
+
+// Answer one request (or a parse error) by queueing the response; with
+// `shed` set the answer is 503
+static void handle_http_request(struct conn *c, long len, int shed) {
+    struct http_request req = {0};
+    int status = 0;                    // 0 until a response is queued
+    const char *error = NULL;
+
+    if (len < 0 || parse_request(c, &req) < 0) {
+        LOG_DEBUG("conn %d: invalid HTTP request", c->id);
+        status = 400;
+        req.method = NULL;
+        req.path = NULL;
+        req.keep_alive = 0;
+        error = "<h1>400 - Bad Request</h1>\n";
+    } else if (strcmp(req.method, "GET") != 0 && strcmp(req.method, "HEAD") != 0) {
+        status = 405;
+        error = "<h1>405 - Method Not Allowed</h1>\n";
+    } else if (shed) {
+        status = 503;
+        error = "<h1>503 - Service Unavailable</h1>\n";
+    } else {
+        LOG_DEBUG("conn %d: %s %.64s (slot %d)", c->id, req.method, req.path, c->slot);
+    }
+
+    if (!server_running) req.keep_alive = 0;
+    if (!req.keep_alive) c->keep_alive = 0;
+    int head_only = req.method && strcmp(req.method, "HEAD") == 0;
+
+    if (!error && strncmp(req.path, STATIC_PREFIX, strlen(STATIC_PREFIX)) == 0) {
+        status = serve_static(c, &req, head_only);
+        if (status == 404) error = "<h1>404 - File Not Found</h1>\n";
+        else if (status != 200) error = "<h1>500 - Internal Server Error</h1>\n";
+    } else if (!error && strcmp(req.path, "/metrics") == 0) {
+        status = serve_metrics(c, &req, head_only);
+        if (status != 200) error = "<h1>500 - Internal Server Error</h1>\n";
+    }
+
+    if (!error && status == 0 && compute_threads > 0 && is_compute_route(req.path)) {
+        struct compute_job *job = NULL;
+        if (compute_reserve() && (job = malloc(sizeof(*job))) == NULL) compute_cancel();
+        if (job) {
+            // Parked until the compute pool is done; see serve_requests()
+            job->c = c;
+            snprintf(job->path, sizeof(job->path), "%s", req.path);
+            job->keep_alive = req.keep_alive;
+            job->head_only = head_only;
+            c->pending_job = job;
+            consume(c, len);
+            return;
+        }
+        status = 503;                  // compute pool saturated
+        error = "<h1>503 - Service Unavailable</h1>\n";
+    }
+
+    if (status != 200) {
+        // Generate response content straight into the connection buffer;
+        // the header is queued first and refers to it
+        size_t body_off = c->out_len;
+        char *body = out_reserve(c, BUFFER_SIZE * 2);
+        if (!body) {
+            c->keep_alive = 0;
+        } else {
+            if (error) snprintf(body, BUFFER_SIZE * 2, "%s", error);
+            else status = generate_response(req.path, body, BUFFER_SIZE * 2);
+            size_t body_len = strlen(body);
+            c->out_len += body_len;
+            queue_body(c, status, body_off, body_len, req.keep_alive, head_only);
+        }
+    }
+    stats_request(req.path, status, c->read_ns);
+
+    if (len > 0) consume(c, len);
+    else c->in_len = 0;
+}
+
+static void spawn_requests(struct conn *c);
+static void after_flush(struct conn *c, int sent);
+
+// Route priority of the first buffered request, from its path
+static int request_priority(const struct conn *c) {
+    const char *path = memchr(c->in, ' ', c->in_len);
+    if (!path) return PRIO_LEVELS - 1;
+    path++;
+    if (strncmp(path, "/test", 5) == 0 && (path[5] == ' ' || path[5] == '?')) return 0;
+    if (strncmp(path, STATIC_PREFIX, strlen(STATIC_PREFIX)) == 0) return 1;
+    return PRIO_LEVELS - 1;            // the cheap generated pages
+}
+
+// Is there room in the request queue for a request at this priority?
+static int admit(int prio) {
+    int depth;
+    #pragma omp atomic read
+    depth = queued;
+    return depth < (long)queue_depth * (prio + 1) / PRIO_LEVELS;
+}
+
+// Answer the buffered requests with 503 on the calling event loop
+static void reject_requests(struct conn *c) {
+    long len;
+    for (int i = 0; i < MAX_PIPELINE && c->keep_alive && c->chunk_count + 2 <= OUT_CHUNKS &&
+                    (len = request_length(c)) != 0; ++i) {
+        handle_http_request(c, len, 1);
+        STAT_ADD(shed, 1);
+    }
+
+    int sent = flush_out(c);
+    if (sent == 0) rearm(c, EPOLLOUT);
+    else after_flush(c, sent);
+}
+
+// Decide what the connection waits for next once its output is sent
+static void after_flush(struct conn *c, int sent) {
+    if (sent < 0) LOG_DEBUG("conn %d: failed to send response", c->id);
+    out_reset(c);
+
+    if (sent < 0) {
+        shutdown_conn(c, SHUT_RDWR);
+    } else if (!c->keep_alive) {
+        shutdown_conn(c, SHUT_WR);
+    } else if (request_length(c) != 0) {
+        spawn_requests(c);             // more pipelined requests buffered
+    } else if (c->eof) {
+        shutdown_conn(c, SHUT_RDWR);
+    } else {
+        rearm(c, EPOLLIN);             // wait for the next request
+    }
+}
+
+// Answer the complete requests in the buffer - runs as an OpenMP task
+static void serve_requests(struct conn *c) {
+    long busy = busy_begin();
+    long len;
+    for (int i = 0; i < MAX_PIPELINE && c->keep_alive && c->chunk_count + 2 <= OUT_CHUNKS &&
+                    (len = request_length(c)) != 0; ++i) {
+        handle_http_request(c, len, 0);
+        if (c->pending_job) break;     // later requests wait for its answer
+    }
+
+    #pragma omp atomic
+    queued--;
+
+    int sent = flush_out(c);
+    if (c->pending_job) {
+        // Earlier answers are out (or stay queued behind it); the job owns
+        // the connection from here on and its event loop finishes up
+        struct compute_job *job = c->pending_job;
+        c->pending_job = NULL;
+        if (sent < 0) {
+            compute_cancel();
+            free(job);
+            after_flush(c, sent);
+        } else {
+            compute_submit(job);
+        }
+    } else if (sent == 0) {
+        rearm(c, EPOLLOUT);
+    } else {
+        after_flush(c, sent);
+    }
+    busy_end(busy);
+}
+
+static void spawn_requests(struct conn *c) {
+    int prio = request_priority(c);
+    #pragma omp atomic
+    queued++;
+
+    // NOTE: task directive creates an asynchronous task
+    // Any thread waiting at the end of the parallel region picks it up
+    // while the event loop goes back to epoll_wait. An event loop never
+    // reaches a scheduling point, so without spare threads the task has
+    // to run right here. priority() is only a hint, and only takes effect
+    // with OMP_MAX_TASK_PRIORITY set.
+    #pragma omp task firstprivate(c) priority(prio) if(io_workers > 0)
+    serve_requests(c);
+}
+
+// Read what the socket has; spawn a task once a request is complete
+static void on_readable(struct conn *c) {
+    if (c->closing) {
+        // Discard whatever the client still sends until it closes
+        char sink[BUFFER_SIZE];
+        ssize_t n;
+        while ((n = recv(c->fd, sink, sizeof(sink), 0)) > 0) {}
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            rearm(c, EPOLLIN);
+        } else {
+            close_conn(c);
+        }
         return;
     }
-    
-    printf("[conn %02d] %s %s\n", conn_id, method, path);
-    
-    // Generate response content
-    generate_response(path, response, sizeof(response));
-    
-    // Determine HTTP status and build full response
-    const char* status_line;
-    if (strstr(path, "/") == path) {  // Valid path
-        status_line = HTTP_200_OK;
+
+    size_t had = c->in_len;
+    while (c->in_len < sizeof(c->in) - 1) {
+        ssize_t n = recv(c->fd, c->in + c->in_len, sizeof(c->in) - 1 - c->in_len, 0);
+        if (n > 0) {
+            c->in_len += n;
+        } else if (n == 0) {
+            c->eof = 1;                // peer closed its side
+            break;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        } else {
+            close_conn(c);
+            return;
+        }
+    }
+    c->in[c->in_len] = '\0';
+    if (c->in_len > had) c->read_ns = now_ns();
+
+    if (request_length(c) != 0) {
+        if (admit(request_priority(c))) spawn_requests(c);
+        else reject_requests(c);       // overloaded: answer 503 right away
+    } else if (c->eof) {
+        close_conn(c);
     } else {
-        status_line = HTTP_404_NOT_FOUND;
-    }
-    
-    // Build complete HTTP response
-    snprintf(http_response, sizeof(http_response), "%s%s", status_line, response);
-    
-    // Send response
-    ssize_t bytes_sent = send(client_socket, http_response, strlen(http_response), 0);
-    if (bytes_sent < 0) {
-        printf("[conn %02d] Failed to send response\n", conn_id);
+        rearm(c, EPOLLIN);             // wait for the rest of the request
+    }
+}
+
+// A compute job finished: queue its page and resume the connection - event
+// loop thread
+static void on_compute_done(struct compute_job *job) {
+    struct conn *c = job->c;
+    size_t len = strlen(job->body);
+    size_t body_off = c->out_len;
+    char *body = out_reserve(c, len);
+    if (body) {
+        memcpy(body, job->body, len);
+        c->out_len += len;
+        queue_body(c, job->status, body_off, len, job->keep_alive, job->head_only);
     } else {
-        printf("[conn %02d] Response sent (%zd bytes)\n", conn_id, bytes_sent);
-    }
-}
-
-// Main connection handler - runs as OpenMP task
-static void handle_connection(int client_socket, int slot_idx, int conn_id) {
-    printf("[conn %02d] Connection started (slot %d, tid %d)\n", 
-           conn_id, slot_idx, omp_get_thread_num());
-    
-    // Set socket timeout
-    struct timeval timeout;
-    timeout.tv_sec = 30;  // 30 second timeout
-    timeout.tv_usec = 0;
-    setsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
-    
-    // Handle the HTTP request
-    handle_http_request(client_socket, conn_id, slot_idx);
-    
-    // Close connection
-    close(client_socket);
-    
-    // Mark slot as free using atomic operation for thread safety
-    #pragma omp atomic write
-    conn_in_use[slot_idx] = 0;
-    
-    printf("[conn %02d] Connection closed\n", conn_id);
+        c->keep_alive = 0;
+    }
+    stats_request(job->path, job->status, c->read_ns);
+    free(job);
+
+    int sent = flush_out(c);
+    if (sent == 0) rearm(c, EPOLLOUT);
+    else after_flush(c, sent);
 }
 
-// Find free connection slot using atomic operations
-static int find_free_slot(void) {
-    for (int i = 0; i < MAX_CONN; ++i) {
-        int used;
-        #pragma omp atomic read
-        used = conn_in_use[i];
-        if (!used) return i;
+static void on_wake(struct loop *lp) {
+    uint64_t count;
+    if (read(lp->wake_fd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+        LOG_ERROR("loop eventfd: %m");
+    }
+
+    // Take the whole stack and answer in completion order
+    struct compute_job *job = __atomic_exchange_n(&lp->done, NULL, __ATOMIC_ACQUIRE), *fifo = NULL;
+    while (job) {
+        struct compute_job *next = job->next;
+        job->next = fifo;
+        fifo = job;
+        job = next;
+    }
+    while (fifo) {
+        struct compute_job *next = fifo->next;
+        on_compute_done(fifo);
+        fifo = next;
+    }
+}
+
+static void on_writable(struct conn *c) {
+    int sent = flush_out(c);
+    if (sent == 0) rearm(c, EPOLLOUT);
+    else after_flush(c, sent);
+}
+
+// Shut down connections of this loop that waited on the client for longer
+// than the idle timeout. Only this loop frees its connections, so once the
+// slot info names this loop the pointer stays valid; the shutdown wakes the
+// connection up and the normal read path closes it.
+static void close_idle(const struct loop *lp, long now) {
+    for (int w = 0; w < slot_words; ++w) {
+        for (uint64_t bits = slot_word(w); bits; bits &= bits - 1) {
+            int i = w * 64 + __builtin_ctzll(bits);
+            uint64_t info = __atomic_load_n(&slot_info[i], __ATOMIC_ACQUIRE);
+            if (info == 0 || INFO_LOOP(info) != lp->index) continue;
+
+            struct conn *c = conn_table[i];
+            long since;
+            #pragma omp atomic read
+            since = c->idle_since;
+            if (since && now - since > idle_timeout_ms) {
+                LOG_DEBUG("conn %d: idle timeout", c->id);
+                shutdown(c->fd, SHUT_RDWR);
+            }
+        }
+    }
+}
+
+// Accept every pending connection on the loop's listening socket
+static void accept_all(struct loop *lp) {
+    for (;;) {
+        struct sockaddr_in client_addr;
+        socklen_t client_len = sizeof(client_addr);
+
+        int client_socket = accept4(lp->listen_fd, (struct sockaddr*)&client_addr, &client_len,
+                                    SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_socket < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK && server_running) LOG_ERROR("accept: %m");
+            return;
+        }
+
+        // Find free slot for this connection
+        int slot = slot_claim(lp);
+        struct conn *c = slot < 0 ? NULL : calloc(1, sizeof(*c));
+        if (!c) {
+            LOG_WARN("no free connection slots, rejecting connection");
+            STAT_ADD(refused, 1);
+            if (slot >= 0) slot_free(slot);
+            close(client_socket);
+            continue;
+        }
+
+        // Allocate connection ID and mark slot as used
+        int id;
+        #pragma omp atomic capture
+        id = next_id++;
+
+        c->fd = client_socket;
+        c->id = id;
+        c->slot = slot;
+        c->loop = lp;
+        c->keep_alive = 1;
+        c->waiting = EPOLLIN;
+        c->idle_since = now_ms();
+
+        // NOTE: the bitmap CAS already made the slot ours; one release
+        // store publishes it to the status pages and the idle sweep
+        conn_table[slot] = c;
+        __atomic_store_n(&slot_info[slot], SLOT_INFO(id, lp->index, 1), __ATOMIC_RELEASE);
+        STAT_ADD(accepted, 1);
+
+        if (LVL_DEBUG <= LOG_LEVEL && log_threshold >= LVL_DEBUG) {
+            char addr[INET_ADDRSTRLEN];
+            inet_ntop(AF_INET, &client_addr.sin_addr, addr, sizeof(addr));
+            LOG_DEBUG("conn %d accepted from %s:%d (slot %d, loop %d)",
+                      id, addr, ntohs(client_addr.sin_port), slot, lp->index);
+        }
+
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLONESHOT;
+        ev.data.ptr = c;
+        if (epoll_ctl(lp->epfd, EPOLL_CTL_ADD, client_socket, &ev) < 0) {
+            LOG_ERROR("conn %d: epoll_ctl: %m", id);
+            close_conn(c);
+        }
+    }
+}
+
+static void event_loop(struct loop *lp) {
+    struct epoll_event events[MAX_EVENTS];
+    long last_sweep = now_ms();
+    stats_register(ROLE_LOOP);
+
+    while (server_running) {
+        int n = epoll_wait(lp->epfd, events, MAX_EVENTS, 1000);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR("epoll_wait: %m");
+            break;
+        }
+        long busy = busy_begin();
+
+        for (int i = 0; i < n; ++i) {
+            struct conn *c = events[i].data.ptr;
+            if (c == NULL) {
+                accept_all(lp);        // the listening socket
+                continue;
+            }
+            if ((void *)c == &wake_tag) {
+                on_wake(lp);           // compute jobs finished
+                continue;
+            }
+
+            // This thread owns the connection now
+            #pragma omp atomic write
+            c->idle_since = 0;
+
+            // Dispatch on what it was parked for: errors and hang-ups are
+            // reported whatever was requested
+            if (c->waiting == EPOLLOUT) {
+                on_writable(c);
+            } else {
+                on_readable(c);
+            }
+        }
+
+        long now = now_ms();
+        if (now - last_sweep >= 1000) {
+            close_idle(lp, now);
+            last_sweep = now;
+        }
+        busy_end(busy);
     }
-    return -1;
 }
 
 // Setup server socket
-static int setup_server_socket(int port) {
-    int sock = socket(AF_INET, SOCK_STREAM, 0);
+static int setup_server_socket(int port, int reuseport) {
+    int sock = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
     if (sock < 0) {
         perror("socket");
         return -1;
     }
-    
+
     // Allow address reuse
     int opt = 1;
     setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-    
+
+    // Several listening sockets on one port; the kernel spreads incoming
+    // connections across them
+    if (reuseport && setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+        perror("setsockopt(SO_REUSEPORT)");
+        close(sock);
+        return -1;
+    }
+
     struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
     addr.sin_family = AF_INET;
     addr.sin_addr.s_addr = INADDR_ANY;
     addr.sin_port = htons(port);
-    
+
     if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
         perror("bind");
         close(sock);
         return -1;
     }
-    
-    if (listen(sock, 10) < 0) {
+
+    if (listen(sock, LISTEN_BACKLOG) < 0) {
         perror("listen");
         close(sock);
         return -1;
     }
-    
+
     return sock;
 }
 
+static int setup_loop(struct loop *lp, int index, int port) {
+    lp->index = index;
+    lp->slot_hint = index * slot_words / num_loops; // spread the loops out
+    lp->listen_fd = setup_server_socket(port, num_loops > 1);
+    if (lp->listen_fd < 0) return -1;
+
+    lp->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (lp->epfd < 0) {
+        perror("epoll_create1");
+        return -1;
+    }
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL; // NULL marks the listening socket
+    if (epoll_ctl(lp->epfd, EPOLL_CTL_ADD, lp->listen_fd, &ev) < 0) {
+        perror("epoll_ctl");
+        return -1;
+    }
+
+    lp->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ev.data.ptr = &wake_tag;
+    if (lp->wake_fd < 0 || epoll_ctl(lp->epfd, EPOLL_CTL_ADD, lp->wake_fd, &ev) < 0) {
+        perror("eventfd");
+        return -1;
+    }
+    return 0;
+}
+
+// Each connection is a file descriptor: lift the soft limit to the hard one
+static void raise_fd_limit(void) {
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+}
+
 int main(int argc, char* argv[]) {
     int port = DEFAULT_PORT;
-    
+
     // Parse command line arguments
-    if (argc > 1) {
-        port = atoi(argv[1]);
-        if (port <= 0 || port > 65535) {
-            fprintf(stderr, "Invalid port number: %s\n", argv[1]);
-            return 1;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) {
+            num_loops = atoi(argv[++i]);
+            if (num_loops < 1 || num_loops > MAX_ACCEPTORS) {
+                fprintf(stderr, "Acceptors must be 1..%d\n", MAX_ACCEPTORS);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            idle_timeout_ms = atoi(argv[++i]) * 1000;
+            if (idle_timeout_ms <= 0) {
+                fprintf(stderr, "Idle timeout must be positive\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            max_conn = atoi(argv[++i]);
+            if (max_conn < 1) {
+                fprintf(stderr, "Max connections must be positive\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            compute_threads = atoi(argv[++i]);
+            if (compute_threads < 0) {
+                fprintf(stderr, "Compute threads must not be negative\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-q") == 0 && i + 1 < argc) {
+            queue_depth = atoi(argv[++i]);
+            if (queue_depth < PRIO_LEVELS) {
+                fprintf(stderr, "Queue depth must be at least %d\n", PRIO_LEVELS);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            doc_root = argv[++i];
+        } else if (strcmp(argv[i], "-v") == 0) {
+            log_threshold = LVL_DEBUG;
+        } else {
+            port = atoi(argv[i]);
+            if (port <= 0 || port > 65535) {
+                fprintf(stderr, "Invalid port number: %s\n", argv[i]);
+                return 1;
+            }
         }
     }
-    
+
     // Setup signal handlers for graceful shutdown
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
-    
+    signal(SIGPIPE, SIG_IGN);          // writev/sendfile to a closed peer
+
     // Configure OpenMP for nested parallelism
     // NOTE: omp_set_dynamic(0) disables dynamic thread adjustment
     // This ensures we get exactly the number of threads we request
     omp_set_dynamic(0);
-    
+
     // NOTE: omp_set_max_active_levels(2) allows nested parallel regions
     // This enables the server to use nested parallelism if needed
     omp_set_max_active_levels(2);
-    
-    // Initialize connection arrays
-    memset(conn_id, 0, sizeof(conn_id));
-    memset(conn_alive, 0, sizeof(conn_alive));
-    memset(conn_in_use, 0, sizeof(conn_in_use));
-    
-    // Setup server socket
-    server_socket = setup_server_socket(port);
-    if (server_socket < 0) {
+
+    // Keep at least one thread free to run request tasks
+    int threads = omp_get_max_threads();
+    if (threads > 1 && num_loops > threads - 1) num_loops = threads - 1;
+    if (threads == 1) num_loops = 1;
+
+    // The compute pool is opened by one thread of the team; it needs at
+    // least one I/O worker left beside it, or compute routes run inline
+    if (threads - num_loops < 2) compute_threads = 0;
+    io_workers = threads - num_loops - (compute_threads > 0);
+
+    // Past TASK_THROTTLE pending tasks per thread libgomp executes a new task
+    // in the thread creating it, i.e. the event loop; shedding has to start
+    // before that
+    int max_depth = TASK_THROTTLE * threads;
+    if (queue_depth == 0) queue_depth = QUEUE_PER_WORKER * (io_workers > 0 ? io_workers : 1);
+    if (queue_depth > max_depth) {
+        fprintf(stderr, "Queue depth capped at %d (%d tasks per thread)\n", max_depth, TASK_THROTTLE);
+        queue_depth = max_depth;
+    }
+    compute_efd = eventfd(0, EFD_SEMAPHORE | EFD_CLOEXEC);
+    if (compute_efd < 0) {
+        perror("eventfd");
         return 1;
     }
-    
+
+    // Initialize the connection table
+    if (slots_init(max_conn) < 0) {
+        fprintf(stderr, "Cannot allocate %d connection slots\n", max_conn);
+        return 1;
+    }
+
+    raise_fd_limit();
+
+    // Setup server sockets, one per event loop
+    for (int i = 0; i < num_loops; ++i) {
+        if (setup_loop(&loops[i], i, port) < 0) {
+            return 1;
+        }
+    }
+
     printf("OpenMP Web Server starting on port %d\n", port);
-    printf("Threads: %d (max: %d), Max connections: %d\n", 
-           omp_get_num_threads(), omp_get_max_threads(), MAX_CONN);
+    printf("Threads: %d, event loops: %d, Max connections: %d, idle timeout: %d s\n",
+           threads, num_loops, max_conn, idle_timeout_ms / 1000);
+    printf("I/O workers: %d, compute threads: %d\n", io_workers, compute_threads);
+    printf("Request queue depth: %d, task priorities: %s\n", queue_depth,
+           omp_get_max_task_priority() >= PRIO_LEVELS - 1 ? "on" : "off (set OMP_MAX_TASK_PRIORITY=2)");
     printf("Press Ctrl+C to stop the server\n\n");
-    
+
+    log_start();
+
     // NOTE: Main parallel region - creates a team of threads
-    // One thread will handle the main accept loop (single directive)
-    // Other threads will execute connection tasks
-    #pragma omp parallel
+    // The first num_loops threads run event loops and create request tasks;
+    // the next one opens the compute pool; the others go straight to the
+    // implicit barrier, where they execute those tasks
+    #pragma omp parallel num_threads(threads)
     {
-        // NOTE: single directive ensures only one thread runs the accept loop
-        // This prevents multiple threads from trying to accept connections simultaneously
-        #pragma omp single
-        {
-            while (server_running) {
-                struct sockaddr_in client_addr;
-                socklen_t client_len = sizeof(client_addr);
-                
-                // Accept new connection
-                int client_socket = accept(server_socket, (struct sockaddr*)&client_addr, &client_len);
-                if (client_socket < 0) {
-                    if (server_running) {
-                        perror("accept");
-                    }
-                    continue;
-                }
-                
-                // Find free slot for this connection
-                int slot = find_free_slot();
-                if (slot < 0) {
-                    printf("No free connection slots, rejecting connection\n");
-                    close(client_socket);
-                    continue;
-                }
-                
-                // Allocate connection ID and mark slot as used
-                int id = next_id++;
-                
-                // NOTE: Atomic operations ensure thread-safe updates to shared arrays
-                // Multiple threads may be accessing these arrays simultaneously
-                #pragma omp atomic write
-                conn_in_use[slot] = 1;
-                #pragma omp atomic write
-                conn_id[slot] = id;
-                #pragma omp atomic write
-                conn_alive[slot] = 1;
-                
-                printf("Accepted connection %02d from %s:%d (slot %d)\n", 
-                       id, inet_ntoa(client_addr.sin_addr), ntohs(client_addr.sin_port), slot);
-                
-                // NOTE: task directive creates an asynchronous task
-                // This allows the connection to be handled by any available thread
-                // while the main thread continues accepting new connections
-                #pragma omp task firstprivate(client_socket, slot, id) shared(conn_in_use)
-                {
-                    handle_connection(client_socket, slot, id);
-                }
-            }
+        int tid = omp_get_thread_num();
+        if (tid < num_loops) {
+            event_loop(&loops[tid]);
+        } else if (tid == num_loops && compute_threads > 0) {
+            compute_pool();
+        }
+
+        // NOTE: the implicit barrier at the end of the parallel region waits
+        // for all tasks, so no request is cut off at shutdown
+    }
+    LOG_INFO("received signal %d, shutting down", (int)stop_signal);
+
+    // Cleanup: connections still parked in epoll
+    for (int w = 0; w < slot_words; ++w) {
+        for (uint64_t bits = slot_word(w); bits; bits &= bits - 1) {
+            close_conn(conn_table[w * 64 + __builtin_ctzll(bits)]);
         }
-        
-        // NOTE: taskwait ensures all tasks complete before the parallel region ends
-        // This prevents the server from shutting down while connections are still active
-        #pragma omp taskwait
     }
-    
-    // Cleanup
-    if (server_socket != -1) {
-        close(server_socket);
+    for (int i = 0; i < num_loops; ++i) {
+        close(loops[i].listen_fd);
+        close(loops[i].epfd);
+        close(loops[i].wake_fd);
     }
-    
+    close(compute_efd);
+
+    log_stop();
     printf("Server shutdown complete\n");
     return 0;
-}
\ No newline at end of file
+}
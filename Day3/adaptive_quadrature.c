@@ -0,0 +1,173 @@
+// Adaptive Quadrature with OpenMP Tasks
+//
+// Instead of cutting [a, b] into a fixed number of equal slices (as
+// riemann_sum_tasks.c does), an adaptive integrator estimates the error on
+// each interval and only splits the intervals where that estimate is above
+// the tolerance. Smooth stretches are covered by a handful of evaluations,
+// the work goes where the integrand is hard.
+//
+// Two error estimators are provided:
+// - Adaptive Simpson: compares Simpson on [a, b] against Simpson on both halves
+//   (2 new evaluations per interval, Richardson-corrected result)
+// - Gauss-Kronrod 7-15: compares the 15-point Kronrod rule against the
+//   embedded 7-point Gauss rule (15 evaluations per interval)
+//
+// The two halves of a split interval become tasks, down to a depth cutoff
+// (like the if(n > 20) cutoff in fibonacci_task_recursion.c); deeper splits
+// run inside the task that reached them. Idle threads steal the pending
+// subinterval tasks, so the threads follow the work wherever the integrand
+// needs refinement.
+
+#include <math.h>
+#include <stdio.h>
+#include <omp.h>
+
+#define MAX_DEPTH 60 // give up refining below (b - a) / 2^60
+#define MAX_THREADS 256
+#define CACHE_LINE_SIZE 64
+#define PAD (CACHE_LINE_SIZE / sizeof(long))
+
+// Per-thread evaluation counters, padded to avoid false sharing
+static long eval_count[MAX_THREADS * PAD];
+
+static void count_evals(long n) {
+    eval_count[(omp_get_thread_num() % MAX_THREADS) * PAD] += n;
+}
+
+static long total_evals(void) {
+    long total = 0;
+    for (int i = 0; i < MAX_THREADS; i++) total += eval_count[i * PAD];
+    return total;
+}
+
+static void reset_evals(void) {
+    for (int i = 0; i < MAX_THREADS; i++) eval_count[i * PAD] = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Adaptive Simpson
+
+static double simpson_rec(double (*f)(double), double a, double b,
+                          double fa, double fm, double fb, double whole,
+                          double tol, int depth, int task_depth) {
+    double m = 0.5 * (a + b);
+    double lm = 0.5 * (a + m), rm = 0.5 * (m + b);
+    double flm = f(lm), frm = f(rm);
+    count_evals(2);
+
+    double left = (m - a) / 6.0 * (fa + 4.0 * flm + fm);
+    double right = (b - m) / 6.0 * (fm + 4.0 * frm + fb);
+    double delta = left + right - whole;
+
+    if (depth >= MAX_DEPTH || fabs(delta) <= 15.0 * tol)
+        return left + right + delta / 15.0;
+
+    double l, r;
+
+    #pragma omp task shared(l) if(depth < task_depth)
+    l = simpson_rec(f, a, m, fa, flm, fm, left, 0.5 * tol, depth + 1, task_depth);
+
+    #pragma omp task shared(r) if(depth < task_depth)
+    r = simpson_rec(f, m, b, fm, frm, fb, right, 0.5 * tol, depth + 1, task_depth);
+
+    #pragma omp taskwait
+    return l + r;
+}
+
+// Integrate f over [a, b] to within tol, returns the number of integrand
+// evaluations in *evaluations
+double adaptive_simpson(double (*f)(double), double a, double b, double tol,
+                        int task_depth, long *evaluations) {
+    double result;
+    reset_evals();
+
+    #pragma omp parallel
+    #pragma omp single
+    {
+        double fa = f(a), fm = f(0.5 * (a + b)), fb = f(b);
+        count_evals(3);
+        double whole = (b - a) / 6.0 * (fa + 4.0 * fm + fb);
+        result = simpson_rec(f, a, b, fa, fm, fb, whole, tol, 0, task_depth);
+    }
+
+    *evaluations = total_evals();
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// Gauss-Kronrod 7-15 (QUADPACK nodes and weights)
+
+static const double xgk[8] = {
+    0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+    0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+    0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+    0.207784955007898467600689403773245, 0.000000000000000000000000000000000};
+static const double wgk[8] = {
+    0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+    0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+    0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+    0.204432940075298892414161999234649, 0.209482141084727828012999174891714};
+// Gauss weights for the nodes xgk[1], xgk[3], xgk[5], xgk[7]
+static const double wg[4] = {
+    0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+    0.381830050505118944950369775488975, 0.417959183673469387755102040816327};
+
+// Kronrod estimate over [a, b], |Kronrod - Gauss| in *err
+static double gk15(double (*f)(double), double a, double b, double *err) {
+    double c = 0.5 * (a + b), h = 0.5 * (b - a);
+    double fc = f(c);
+    double kronrod = wgk[7] * fc, gauss = wg[3] * fc;
+
+    for (int j = 0; j < 7; j++) {
+        double dx = h * xgk[j];
+        double fsum = f(c - dx) + f(c + dx);
+        kronrod += wgk[j] * fsum;
+        if (j % 2 == 1) gauss += wg[j / 2] * fsum;
+    }
+    count_evals(15);
+
+    *err = fabs((kronrod - gauss) * h);
+    return kronrod * h;
+}
+
+static double gk_rec(double (*f)(double), double a, double b, double estimate, double err,
+                     double tol, int depth, int task_depth) {
+    if (depth >= MAX_DEPTH || err <= tol) return estimate;
+
+    double m = 0.5 * (a + b);
+    double l, r;
+
+    #pragma omp task shared(l) if(depth < task_depth)
+    {
+        double e;
+        double est = gk15(f, a, m, &e);
+        l = gk_rec(f, a, m, est, e, 0.5 * tol, depth + 1, task_depth);
+    }
+
+    #pragma omp task shared(r) if(depth < task_depth)
+    {
+        double e;
+        double est = gk15(f, m, b, &e);
+        r = gk_rec(f, m, b, est, e, 0.5 * tol, depth + 1, task_depth);
+    }
+
+    #pragma omp taskwait
+    return l + r;
+}
+
+double adaptive_gauss_kronrod(double (*f)(double), double a, double b, double tol,
+                              int task_depth, long *evaluations) {
+    double result;
+    reset_evals();
+
+    #pragma omp parallel
+    #pragma omp single
+    {
+        double err;
+        double est = gk15(f, a, b, &err);
+        result = gk_rec(f, a, b, est, err, tol, 0, task_depth);
+    }
+
+    *evaluations = total_evals();
+    return result;
+}
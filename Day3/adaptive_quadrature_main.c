@@ -0,0 +1,109 @@
+// Adaptive Quadrature - Main Program
+//
+// Runs the uniform 2^28-slice Riemann sum from riemann_sum_tasks.c, then asks
+// both adaptive integrators for the same accuracy and reports how many
+// integrand evaluations they needed. Each is set against the number of
+// uniform midpoint slices that reach the same accuracy, found by doubling.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <omp.h>
+
+#define PI_REF 3.14159265358979323846
+#define TASK_DEPTH 12 // subintervals become tasks down to this depth
+#define UNIFORM_MAX_LOG2 28 // give up matching the accuracy beyond 2^28 slices
+
+// Function declarations
+double compute_pi_riemann_task();
+double adaptive_simpson(double (*f)(double), double a, double b, double tol,
+                        int task_depth, long *evaluations);
+double adaptive_gauss_kronrod(double (*f)(double), double a, double b, double tol,
+                              int task_depth, long *evaluations);
+
+static double pi_integrand(double x) { return 4.0 / (1.0 + x * x); }
+
+// Infinite slope at 0: uniform slices converge slowly, adaptive ones refine near 0
+static double sqrt_integrand(double x) { return sqrt(x); }
+
+// Uniform midpoint rule with n slices
+static double uniform_midpoint(double (*f)(double), long n) {
+    const double h = 1.0 / (double)n;
+    double sum = 0.0;
+    #pragma omp parallel for reduction(+:sum) schedule(static)
+    for (long i = 0; i < n; i++) sum += f((i + 0.5) * h);
+    return sum * h;
+}
+
+// Fewest slices (a power of two) at which the uniform midpoint rule on [0, 1]
+// is within err of exact and stays there at twice as many, so a lucky
+// rounding does not count; 0 if 2^UNIFORM_MAX_LOG2 slices are not enough
+static long uniform_evals_for(double (*f)(double), double exact, double err) {
+    int within = fabs(uniform_midpoint(f, 16) - exact) <= err;
+    for (long n = 16; n < (1L << UNIFORM_MAX_LOG2); n *= 2) {
+        int next = fabs(uniform_midpoint(f, 2 * n) - exact) <= err;
+        if (within && next) return n;
+        within = next;
+    }
+    return 0;
+}
+
+// One adaptive result next to the uniform slice count for the same accuracy
+static void report(const char *name, double value, double exact, long evals, double seconds, long uniform_evals) {
+    printf("%-16s value=%.15f err=%.2e evals=%-10ld time=%.4fs", name, value, fabs(value - exact), evals,
+           seconds);
+    if (uniform_evals > 0)
+        printf(" uniform at equal error=%ld (%.1fx)\n", uniform_evals, (double)uniform_evals / (double)evals);
+    else
+        printf(" uniform at equal error=>2^%d\n", UNIFORM_MAX_LOG2);
+}
+
+int main(int argc, char **argv) {
+    int task_depth = argc > 1 ? atoi(argv[1]) : TASK_DEPTH;
+    const long uniform_evals = 1L << 28;
+    long evals, matched;
+
+    printf("Adaptive quadrature: %d threads, task depth cutoff %d\n\n", omp_get_max_threads(), task_depth);
+
+    // Uniform baseline
+    double t0 = omp_get_wtime();
+    double pi_uniform = compute_pi_riemann_task();
+    double t1 = omp_get_wtime();
+    double target = fabs(pi_uniform - PI_REF);
+    if (target < 1e-14) target = 1e-14; // below that it is all rounding noise
+
+    printf("pi = integral of 4/(1+x^2) on [0, 1]\n");
+    printf("%-16s value=%.15f err=%.2e evals=%-10ld time=%.4fs\n",
+           "uniform 2^28", pi_uniform, fabs(pi_uniform - PI_REF), uniform_evals, t1 - t0);
+
+    t0 = omp_get_wtime();
+    double pi_simpson = adaptive_simpson(pi_integrand, 0.0, 1.0, target, task_depth, &evals);
+    t1 = omp_get_wtime();
+    // Both adaptive errors may undershoot the target; match what each reached
+    matched = uniform_evals_for(pi_integrand, PI_REF, fmax(fabs(pi_simpson - PI_REF), target));
+    report("adaptive simpson", pi_simpson, PI_REF, evals, t1 - t0, matched);
+
+    t0 = omp_get_wtime();
+    double pi_gk = adaptive_gauss_kronrod(pi_integrand, 0.0, 1.0, target, task_depth, &evals);
+    t1 = omp_get_wtime();
+    matched = uniform_evals_for(pi_integrand, PI_REF, fmax(fabs(pi_gk - PI_REF), target));
+    report("gauss-kronrod", pi_gk, PI_REF, evals, t1 - t0, matched);
+
+    // A harder integrand where the refinement is visibly non-uniform
+    const double tol = 1e-10;
+    printf("\n2/3 = integral of sqrt(x) on [0, 1], tol %.0e\n", tol);
+
+    t0 = omp_get_wtime();
+    double s = adaptive_simpson(sqrt_integrand, 0.0, 1.0, tol, task_depth, &evals);
+    t1 = omp_get_wtime();
+    matched = uniform_evals_for(sqrt_integrand, 2.0 / 3.0, fmax(fabs(s - 2.0 / 3.0), tol));
+    report("adaptive simpson", s, 2.0 / 3.0, evals, t1 - t0, matched);
+
+    t0 = omp_get_wtime();
+    s = adaptive_gauss_kronrod(sqrt_integrand, 0.0, 1.0, tol, task_depth, &evals);
+    t1 = omp_get_wtime();
+    matched = uniform_evals_for(sqrt_integrand, 2.0 / 3.0, fmax(fabs(s - 2.0 / 3.0), tol));
+    report("gauss-kronrod", s, 2.0 / 3.0, evals, t1 - t0, matched);
+
+    return 0;
+}
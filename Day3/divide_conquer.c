@@ -0,0 +1,62 @@
+// Parallel divide-and-conquer skeleton (see divide_conquer.h)
+
+#include "divide_conquer.h"
+
+#include <omp.h>
+
+// Stack storage for problems and results of any size, aligned for any member
+typedef union {
+    long double ld;
+    long long ll;
+    void *p;
+} dc_slot;
+
+#define SLOTS(size) ((size) / sizeof(dc_slot) + 1)
+
+static void dc_rec(const dc_ops *ops, void *ctx, void *problem, void *result, int depth, int tasks) {
+    if (ops->is_base(problem, ctx)) {
+        ops->base(problem, result, ctx);
+        return;
+    }
+
+    dc_slot lbuf[SLOTS(ops->problem_size)], rbuf[SLOTS(ops->problem_size)];
+    dc_slot lres[SLOTS(ops->result_size)], rres[SLOTS(ops->result_size)];
+    // Tasks capture these pointers, not copies of the buffers
+    void *left = lbuf, *right = rbuf, *left_result = lres, *right_result = rres;
+
+    ops->divide(problem, left, right, ctx);
+
+    if (tasks) {
+        if (ops->cutoff) tasks = !ops->cutoff(problem, depth, ctx);
+        else tasks = depth < ops->task_depth;
+    }
+
+    if (tasks) {
+        #pragma omp task
+        dc_rec(ops, ctx, left, left_result, depth + 1, 1);
+
+        dc_rec(ops, ctx, right, right_result, depth + 1, 1);
+
+        #pragma omp taskwait
+    } else {
+        dc_rec(ops, ctx, left, left_result, depth + 1, 0);
+        dc_rec(ops, ctx, right, right_result, depth + 1, 0);
+    }
+
+    ops->combine(problem, left_result, right_result, result, ctx);
+}
+
+void dc_solve(const dc_ops *ops, void *ctx, void *problem, void *result) {
+    if (omp_in_parallel()) {
+        dc_rec(ops, ctx, problem, result, 0, 1);
+        return;
+    }
+
+    #pragma omp parallel
+    #pragma omp single
+    dc_rec(ops, ctx, problem, result, 0, 1);
+}
+
+void dc_solve_sequential(const dc_ops *ops, void *ctx, void *problem, void *result) {
+    dc_rec(ops, ctx, problem, result, 0, 0);
+}
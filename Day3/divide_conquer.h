@@ -0,0 +1,42 @@
+// Parallel divide-and-conquer skeleton
+//
+// The spawn-tasks-then-taskwait recursion of fibonacci_task_recursion.c and
+// how-many.c, written once. A problem is described by callbacks:
+//
+//   is_base(p)             small enough to solve directly?
+//   base(p, r)             solve p directly into result r
+//   divide(p, left, right) split p into two subproblems
+//   combine(p, rl, rr, r)  build the result of p from the two subresults
+//   cutoff(p, depth)       nonzero: solve this subtree without tasks
+//
+// Problems and results are opaque byte blobs of problem_size / result_size;
+// the skeleton keeps the subproblems and subresults on the stack of the
+// recursion. Above the cutoff the left half becomes a task and the right
+// half runs in the current task; below it both run inline.
+
+#ifndef DIVIDE_CONQUER_H
+#define DIVIDE_CONQUER_H
+
+#include <stddef.h>
+
+#define DC_TASK_DEPTH 12 // default cutoff when no callback is given
+
+typedef struct {
+    size_t problem_size;
+    size_t result_size; // 0 for in-place algorithms
+    int (*is_base)(const void *problem, void *ctx);
+    void (*base)(void *problem, void *result, void *ctx);
+    void (*divide)(void *problem, void *left, void *right, void *ctx);
+    void (*combine)(void *problem, void *left_result, void *right_result, void *result, void *ctx);
+    int (*cutoff)(const void *problem, int depth, void *ctx); // NULL: depth >= task_depth
+    int task_depth;
+} dc_ops;
+
+// Solve problem into result. Opens a parallel region unless called from
+// inside one, in which case the calling thread's team runs the tasks.
+void dc_solve(const dc_ops *ops, void *ctx, void *problem, void *result);
+
+// Same recursion with no tasks at all
+void dc_solve_sequential(const dc_ops *ops, void *ctx, void *problem, void *result);
+
+#endif
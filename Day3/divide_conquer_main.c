@@ -0,0 +1,241 @@
+// Divide-and-Conquer Skeleton - Main Program
+//
+// usage: divide_conquer [n]
+//
+// Three workloads on the skeleton in divide_conquer.c, each run with tasks
+// and without, and checked against a plain sequential answer:
+// - mergesort: split in halves, merge through a scratch buffer
+// - quicksort: the work is in divide (partitioning), combine does nothing
+// - tree-reduce: sum of an array, combine adds the two halves
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+#include "divide_conquer.h"
+
+#define N (1L << 23)
+#define SORT_GRAIN 32        // insertion sort below this
+#define REDUCE_GRAIN 4096    // plain loop below this
+#define TASK_GRAIN (1L << 14) // no tasks below this many elements
+
+// ---------------------------------------------------------------------------
+// Sorting
+
+typedef struct {
+    double *a, *tmp;
+    long n;
+} sort_problem;
+
+static void insertion_sort(double *a, long n) {
+    for (long i = 1; i < n; i++) {
+        double v = a[i];
+        long j = i - 1;
+        while (j >= 0 && a[j] > v) {
+            a[j + 1] = a[j];
+            j--;
+        }
+        a[j + 1] = v;
+    }
+}
+
+static int sort_is_base(const void *problem, void *ctx) {
+    (void)ctx;
+    return ((const sort_problem *)problem)->n <= SORT_GRAIN;
+}
+
+static void sort_base(void *problem, void *result, void *ctx) {
+    (void)result;
+    (void)ctx;
+    sort_problem *p = problem;
+    insertion_sort(p->a, p->n);
+}
+
+static int sort_cutoff(const void *problem, int depth, void *ctx) {
+    (void)depth;
+    (void)ctx;
+    return ((const sort_problem *)problem)->n < TASK_GRAIN;
+}
+
+static void merge_divide(void *problem, void *left, void *right, void *ctx) {
+    (void)ctx;
+    sort_problem *p = problem, *l = left, *r = right;
+    long half = p->n / 2;
+    *l = (sort_problem){p->a, p->tmp, half};
+    *r = (sort_problem){p->a + half, p->tmp + half, p->n - half};
+}
+
+static void merge_combine(void *problem, void *lr, void *rr, void *result, void *ctx) {
+    (void)lr;
+    (void)rr;
+    (void)result;
+    (void)ctx;
+    sort_problem *p = problem;
+    long half = p->n / 2, i = 0, j = half, k = 0;
+
+    while (i < half && j < p->n) p->tmp[k++] = p->a[i] <= p->a[j] ? p->a[i++] : p->a[j++];
+    while (i < half) p->tmp[k++] = p->a[i++];
+    while (j < p->n) p->tmp[k++] = p->a[j++];
+    memcpy(p->a, p->tmp, p->n * sizeof(double));
+}
+
+static void quick_divide(void *problem, void *left, void *right, void *ctx) {
+    (void)ctx;
+    sort_problem *p = problem, *l = left, *r = right;
+    double *a = p->a;
+    long n = p->n;
+
+    // Median of three as pivot, Hoare partition
+    double x = a[0], y = a[n / 2], z = a[n - 1];
+    double pivot = x < y ? (y < z ? y : (x < z ? z : x)) : (x < z ? x : (y < z ? z : y));
+    long i = -1, j = n;
+    for (;;) {
+        do i++; while (a[i] < pivot);
+        do j--; while (a[j] > pivot);
+        if (i >= j) break;
+        double t = a[i];
+        a[i] = a[j];
+        a[j] = t;
+    }
+
+    *l = (sort_problem){a, NULL, j + 1};
+    *r = (sort_problem){a + j + 1, NULL, n - j - 1};
+}
+
+static void quick_combine(void *problem, void *lr, void *rr, void *result, void *ctx) {
+    (void)problem;
+    (void)lr;
+    (void)rr;
+    (void)result;
+    (void)ctx;
+}
+
+static const dc_ops mergesort_ops = {
+    sizeof(sort_problem), 0, sort_is_base, sort_base, merge_divide, merge_combine, sort_cutoff, 0};
+
+static const dc_ops quicksort_ops = {
+    sizeof(sort_problem), 0, sort_is_base, sort_base, quick_divide, quick_combine, sort_cutoff, 0};
+
+// ---------------------------------------------------------------------------
+// Tree reduction
+
+typedef struct {
+    const double *a;
+    long n;
+} reduce_problem;
+
+static int reduce_is_base(const void *problem, void *ctx) {
+    (void)ctx;
+    return ((const reduce_problem *)problem)->n <= REDUCE_GRAIN;
+}
+
+static void reduce_base(void *problem, void *result, void *ctx) {
+    (void)ctx;
+    const reduce_problem *p = problem;
+    double sum = 0.0;
+    for (long i = 0; i < p->n; i++) sum += p->a[i];
+    *(double *)result = sum;
+}
+
+static void reduce_divide(void *problem, void *left, void *right, void *ctx) {
+    (void)ctx;
+    reduce_problem *p = problem, *l = left, *r = right;
+    long half = p->n / 2;
+    *l = (reduce_problem){p->a, half};
+    *r = (reduce_problem){p->a + half, p->n - half};
+}
+
+static void reduce_combine(void *problem, void *lr, void *rr, void *result, void *ctx) {
+    (void)problem;
+    (void)ctx;
+    *(double *)result = *(double *)lr + *(double *)rr;
+}
+
+static int reduce_cutoff(const void *problem, int depth, void *ctx) {
+    (void)depth;
+    (void)ctx;
+    return ((const reduce_problem *)problem)->n < TASK_GRAIN;
+}
+
+static const dc_ops reduce_ops = {
+    sizeof(reduce_problem), sizeof(double), reduce_is_base, reduce_base, reduce_divide, reduce_combine,
+    reduce_cutoff, 0};
+
+// ---------------------------------------------------------------------------
+
+static int cmp_double(const void *x, const void *y) {
+    double a = *(const double *)x, b = *(const double *)y;
+    return (a > b) - (a < b);
+}
+
+static void report(const char *name, double seq, double par, int ok) {
+    printf("%-12s sequential=%.4f s  tasks=%.4f s  speedup=%5.2fx  %s\n",
+           name, seq, par, seq / par, ok ? "OK" : "WRONG");
+}
+
+// Sort a copy of data with ops, with and without tasks, and check against ref
+static void run_sort(const char *name, const dc_ops *ops, const double *data, const double *ref,
+                     double *a, double *tmp, long n) {
+    sort_problem p = {a, tmp, n};
+
+    memcpy(a, data, n * sizeof(double));
+    double t0 = omp_get_wtime();
+    dc_solve_sequential(ops, NULL, &p, NULL);
+    double seq = omp_get_wtime() - t0;
+    int ok = memcmp(a, ref, n * sizeof(double)) == 0;
+
+    memcpy(a, data, n * sizeof(double));
+    t0 = omp_get_wtime();
+    dc_solve(ops, NULL, &p, NULL);
+    double par = omp_get_wtime() - t0;
+    ok = ok && memcmp(a, ref, n * sizeof(double)) == 0;
+
+    report(name, seq, par, ok);
+}
+
+int main(int argc, char **argv) {
+    long n = argc > 1 ? atol(argv[1]) : N;
+    if (n < 2) n = 2;
+
+    double *data = malloc(n * sizeof(double));
+    double *ref = malloc(n * sizeof(double));
+    double *a = malloc(n * sizeof(double));
+    double *tmp = malloc(n * sizeof(double));
+    if (!data || !ref || !a || !tmp) {
+        printf("out of memory for n=%ld\n", n);
+        return 1;
+    }
+
+    srand(12345);
+    for (long i = 0; i < n; i++) data[i] = (double)rand() / RAND_MAX;
+
+    printf("Divide and conquer: n=%ld, %d threads\n\n", n, omp_get_max_threads());
+
+    memcpy(ref, data, n * sizeof(double));
+    double t0 = omp_get_wtime();
+    qsort(ref, n, sizeof(double), cmp_double);
+    printf("%-12s %.4f s\n", "libc qsort", omp_get_wtime() - t0);
+
+    run_sort("mergesort", &mergesort_ops, data, ref, a, tmp, n);
+    run_sort("quicksort", &quicksort_ops, data, ref, a, tmp, n);
+
+    // Tree-reduce; the sequential tree sums in the same order, so the
+    // task version must match it exactly
+    reduce_problem r = {data, n};
+    double seq_sum, par_sum;
+    t0 = omp_get_wtime();
+    dc_solve_sequential(&reduce_ops, NULL, &r, &seq_sum);
+    double seq = omp_get_wtime() - t0;
+    t0 = omp_get_wtime();
+    dc_solve(&reduce_ops, NULL, &r, &par_sum);
+    double par = omp_get_wtime() - t0;
+    report("tree-reduce", seq, par, seq_sum == par_sum);
+    printf("%-12s sum=%.6f\n", "", par_sum);
+
+    free(data);
+    free(ref);
+    free(a);
+    free(tmp);
+    return 0;
+}
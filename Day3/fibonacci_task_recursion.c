@@ -1,33 +1,206 @@
 // Fibonacci Computation using OpenMP Tasks with Cutoff Strategy
+//
+// fib(n) spawns fib(n-1) and fib(n-2) as tasks down to a cutoff, below which
+// the recursion runs inside the task that reached it. Options:
+// - the cutoff, fixed or tuned from the measured cost of a task spawn
+// - if() or final()/mergeable to switch tasking off below the cutoff
+// - a memo table shared by all tasks, so each subproblem is computed once
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <omp.h>
 
-long fib(int n) {
+#include "fibonacci_task_recursion.h"
+
+#define MAX_THREADS 256
+#define CACHE_LINE_SIZE 64
+#define PAD (CACHE_LINE_SIZE / sizeof(double))
+
+// A subproblem below the cutoff should cost this many task spawns
+#define FIB_GRAIN_FACTOR 50
+#define TUNE_N 22
+
+// Per-thread task counters and spawn times, padded to avoid false sharing
+static double spawn_time[MAX_THREADS * PAD];
+static long spawn_count[MAX_THREADS * PAD];
+
+static void reset_stats(void) {
+    for (int i = 0; i < MAX_THREADS; i++) {
+        spawn_time[i * PAD] = 0.0;
+        spawn_count[i * PAD] = 0;
+    }
+}
+
+static void record_spawn(double seconds, int tasks) {
+    int slot = (omp_get_thread_num() % MAX_THREADS) * PAD;
+    spawn_time[slot] += seconds;
+    spawn_count[slot] += tasks;
+}
+
+fib_options fib_default_options(void) {
+    fib_options opt = {FIB_CUTOFF, FIB_MODE_IF, 0, 0};
+    return opt;
+}
+
+long fib_sequential(int n) {
+    return n < 2 ? n : fib_sequential(n - 1) + fib_sequential(n - 2);
+}
+
+// With `timed` set, every task construct is clocked and counted for
+// fib_stats; without it the recursion pays for neither
+
+static long fib(int n, int cutoff, int timed) {
+    if (n < 2) return n;
+    if (n <= cutoff) return fib_sequential(n);
+
+    long x, y;
+    int defer_x = n - 1 > cutoff, defer_y = n - 2 > cutoff;
+    double t0 = timed ? omp_get_wtime() : 0.0;
+
+    // defer tasks only when n is big enough (cutoff); a child at or below
+    // the cutoff runs undeferred, right here, as the sequential recursion
+    #pragma omp task shared(x) if(defer_x)
+    x = fib(n - 1, cutoff, timed);
+
+    double t1 = timed ? omp_get_wtime() : 0.0;
+
+    #pragma omp task shared(y) if(defer_y)
+    y = fib(n - 2, cutoff, timed);
+
+    // An undeferred task's time is its work, not a spawn
+    if (timed) record_spawn((defer_x ? t1 - t0 : 0.0) + (defer_y ? omp_get_wtime() - t1 : 0.0), defer_x + defer_y);
+
+    #pragma omp taskwait
+    return x + y;
+}
+
+// The tasks below the cutoff are final: everything they spawn runs inline
+static long fib_final(int n, int cutoff, int timed) {
     if (n < 2) return n;
+    if (omp_in_final()) return fib_sequential(n);
 
     long x, y;
+    double t0 = timed ? omp_get_wtime() : 0.0;
+
+    #pragma omp task shared(x) final(n - 1 <= cutoff) mergeable
+    x = fib_final(n - 1, cutoff, timed);
 
-    // spawn tasks only when n is big enough (cutoff)
-    #pragma omp task shared(x) if(n > 20)
-    x = fib(n - 1);
+    #pragma omp task shared(y) final(n - 2 <= cutoff) mergeable
+    y = fib_final(n - 2, cutoff, timed);
 
-    #pragma omp task shared(y) if(n > 20)
-    y = fib(n - 2);
+    if (timed) record_spawn(omp_get_wtime() - t0, 2);
 
     #pragma omp taskwait
     return x + y;
 }
 
-// Entry point function that can be called as a task
-long compute_fibonacci_task(int n) {
-    long ans;
-    
-    #pragma omp parallel
+// memo[n] is -1 until some task has finished fib(n)
+static long fib_memo(int n, int cutoff, long *memo, int timed) {
+    if (n < 2) return n;
+
+    long known;
+    #pragma omp atomic read
+    known = memo[n];
+    if (known >= 0) return known;
+
+    long x, y;
+    if (n <= cutoff) {
+        x = fib_memo(n - 1, cutoff, memo, timed);
+        y = fib_memo(n - 2, cutoff, memo, timed);
+    } else {
+        double t0 = timed ? omp_get_wtime() : 0.0;
+
+        #pragma omp task shared(x)
+        x = fib_memo(n - 1, cutoff, memo, timed);
+
+        #pragma omp task shared(y)
+        y = fib_memo(n - 2, cutoff, memo, timed);
+
+        if (timed) record_spawn(omp_get_wtime() - t0, 2);
+
+        #pragma omp taskwait
+    }
+
+    // Two tasks may both compute fib(n); they store the same value
+    #pragma omp atomic write
+    memo[n] = x + y;
+    return x + y;
+}
+
+long fib_tasks(int n, const fib_options *opt, fib_stats *stats) {
+    long ans, *memo = NULL;
+    int threads = opt->num_threads > 0 ? opt->num_threads : omp_get_max_threads();
+    int timed = stats != NULL;
+
+    reset_stats();
+    if (opt->memo) {
+        memo = malloc((n + 1 > 2 ? n + 1 : 2) * sizeof(long));
+        if (!memo) abort();
+        for (int i = 0; i <= n; i++) memo[i] = -1;
+    }
+
+    #pragma omp parallel num_threads(threads)
     {
         #pragma omp single
-        ans = fib(n);
+        {
+            if (opt->memo) ans = fib_memo(n, opt->cutoff, memo, timed);
+            else if (opt->mode == FIB_MODE_FINAL) ans = fib_final(n, opt->cutoff, timed);
+            else ans = fib(n, opt->cutoff, timed);
+        }
+    }
+
+    free(memo);
+
+    if (stats) {
+        stats->tasks = 0;
+        stats->spawn_seconds = 0.0;
+        for (int i = 0; i < MAX_THREADS; i++) {
+            stats->tasks += spawn_count[i * PAD];
+            stats->spawn_seconds += spawn_time[i * PAD];
+        }
     }
-    
     return ans;
 }
+
+// Deferred tasks fib() creates for fib(n) with this cutoff
+static long fib_task_count(int n, int cutoff) {
+    if (n < 2 || n <= cutoff) return 0;
+    return (n - 1 > cutoff) + (n - 2 > cutoff) + fib_task_count(n - 1, cutoff) + fib_task_count(n - 2, cutoff);
+}
+
+// Average time of fib_sequential(n), over at least 0.1 ms of repetitions
+static double time_sequential(int n) {
+    volatile long sink;
+    int reps = 0;
+    double t0 = omp_get_wtime(), t1;
+    do {
+        sink = fib_sequential(n);
+        reps++;
+        t1 = omp_get_wtime();
+    } while (t1 - t0 < 1e-4);
+    (void)sink;
+    return (t1 - t0) / reps;
+}
+
+int fib_tune_cutoff(void) {
+    // Overhead per task: fib(TUNE_N) with a task for every call, minus the
+    // plain recursion, divided by the number of tasks. The probe runs on one
+    // thread: with more, the parallel speedup would hide the overhead.
+    fib_options probe = {0, FIB_MODE_IF, 0, 1};
+    double t0 = omp_get_wtime();
+    fib_tasks(TUNE_N, &probe, NULL);
+    double overhead = omp_get_wtime() - t0 - time_sequential(TUNE_N);
+    if (overhead <= 0.0) return FIB_CUTOFF; // too noisy to tell
+    double per_task = overhead / fib_task_count(TUNE_N, 0);
+
+    // Grow n until the sequential subproblem outweighs the spawn
+    for (int n = 2; n < 40; n++)
+        if (time_sequential(n) >= FIB_GRAIN_FACTOR * per_task) return n;
+    return 40;
+}
+
+// Entry point function that can be called as a task
+long compute_fibonacci_task(int n) {
+    fib_options opt = fib_default_options();
+    return fib_tasks(n, &opt, NULL);
+}
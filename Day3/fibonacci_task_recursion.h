@@ -0,0 +1,39 @@
+// Fibonacci Computation using OpenMP Tasks - task recursion options and stats
+
+#ifndef FIBONACCI_TASK_RECURSION_H
+#define FIBONACCI_TASK_RECURSION_H
+
+#define FIB_CUTOFF 20 // default: spawn tasks only for n > 20
+
+typedef enum {
+    FIB_MODE_IF,    // task if(n > cutoff): small subproblems run undeferred, sequentially
+    FIB_MODE_FINAL, // final(n <= cutoff) mergeable: whole subtrees run inline
+} fib_mode;
+
+typedef struct {
+    int cutoff;
+    fib_mode mode;
+    int memo;        // share a memo table of finished subproblems across tasks
+    int num_threads; // 0 = OpenMP default
+} fib_options;
+
+typedef struct {
+    long tasks;           // deferred tasks spawned
+    double spawn_seconds; // time spent in the task constructs, summed over threads
+} fib_stats;
+
+fib_options fib_default_options(void);
+
+long fib_sequential(int n);
+
+// fib(n) with tasks; stats may be NULL, which also skips the spawn timing
+long fib_tasks(int n, const fib_options *opt, fib_stats *stats);
+
+// Smallest n whose sequential fib costs at least FIB_GRAIN_FACTOR task spawns,
+// measured on this machine
+int fib_tune_cutoff(void);
+
+// Entry point function that can be called as a task (default options)
+long compute_fibonacci_task(int n);
+
+#endif
@@ -1,19 +1,59 @@
 // Fibonacci Task Recursion - Main Program
+//
+// usage: fibonacci_task_recursion [n] [cutoff | auto]
+//
+// Compares the sequential recursion against the task versions: fixed and
+// tuned cutoff, if() vs final()/mergeable, and the shared memo table.
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <omp.h>
 
-// Function declaration
-long compute_fibonacci_task(int n);
+#include "fibonacci_task_recursion.h"
 
-int main() {
-    int n = 40;
+static void report(const char *name, long ans, double seconds, const fib_stats *stats, double seq_time) {
+    printf("%-22s fib=%-12ld time=%8.4f s  tasks=%-9ld spawn=%8.4f s  speedup=%6.2fx\n",
+           name, ans, seconds, stats->tasks, stats->spawn_seconds, seq_time / seconds);
+}
+
+int main(int argc, char **argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 40;
+    int tuned = fib_tune_cutoff();
+    int cutoff = (argc > 2 && strcmp(argv[2], "auto") != 0) ? atoi(argv[2]) : tuned;
+    fib_options opt = fib_default_options();
+    fib_stats stats;
+    char name[32];
+
+    printf("fib(%d) with %d threads, tuned cutoff %d\n\n", n, omp_get_max_threads(), tuned);
 
     double t0 = omp_get_wtime();
-    long ans = compute_fibonacci_task(n);
-    double t1 = omp_get_wtime();
+    long ans = fib_sequential(n);
+    double seq_time = omp_get_wtime() - t0;
+    printf("%-22s fib=%-12ld time=%8.4f s\n", "sequential", ans, seq_time);
+
+    t0 = omp_get_wtime();
+    ans = fib_tasks(n, &opt, &stats);
+    report("if, cutoff 20", ans, omp_get_wtime() - t0, &stats, seq_time);
+
+    opt.cutoff = cutoff;
+    snprintf(name, sizeof(name), "if, cutoff %d", cutoff);
+    t0 = omp_get_wtime();
+    ans = fib_tasks(n, &opt, &stats);
+    report(name, ans, omp_get_wtime() - t0, &stats, seq_time);
+
+    opt.mode = FIB_MODE_FINAL;
+    snprintf(name, sizeof(name), "final, cutoff %d", cutoff);
+    t0 = omp_get_wtime();
+    ans = fib_tasks(n, &opt, &stats);
+    report(name, ans, omp_get_wtime() - t0, &stats, seq_time);
+
+    opt.mode = FIB_MODE_IF;
+    opt.memo = 1;
+    snprintf(name, sizeof(name), "memo, cutoff %d", cutoff);
+    t0 = omp_get_wtime();
+    ans = fib_tasks(n, &opt, &stats);
+    report(name, ans, omp_get_wtime() - t0, &stats, seq_time);
 
-    printf("fib(%d) = %ld\n", n, ans);
-    printf("time: %.3f s with %d threads\n", t1 - t0, omp_get_max_threads());
     return 0;
 }
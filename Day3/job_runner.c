@@ -0,0 +1,96 @@
+// Concurrent job runner on one shared task pool (see job_runner.h)
+
+#define _POSIX_C_SOURCE 199309L
+#include "job_runner.h"
+
+#include <time.h>
+#include <omp.h>
+
+#define MAX_THREADS 256
+#define CACHE_LINE_SIZE 64
+#define PAD (CACHE_LINE_SIZE / sizeof(double))
+
+// Per-thread busy time, padded to avoid false sharing. In nested mode
+// omp_get_thread_num() is the inner team's number, so threads of different
+// teams share slots: updates are atomic.
+static double busy[MAX_THREADS * PAD];
+
+double job_cpu_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+void job_busy_add(double seconds) {
+    #pragma omp atomic
+    busy[(omp_get_thread_num() % MAX_THREADS) * PAD] += seconds;
+}
+
+static void reset_busy(void) {
+    for (int i = 0; i < MAX_THREADS; i++) busy[i * PAD] = 0.0;
+}
+
+static double total_busy(void) {
+    double sum = 0.0;
+    for (int i = 0; i < MAX_THREADS; i++) sum += busy[i * PAD];
+    return sum;
+}
+
+void job_run_all(job *jobs, int njobs, int threads, job_report *report) {
+    if (threads <= 0) threads = omp_get_max_threads();
+    reset_busy();
+
+    double t0 = omp_get_wtime();
+
+    #pragma omp parallel num_threads(threads)
+    #pragma omp single
+    {
+        report->threads = omp_get_num_threads();
+        report->cores = report->threads < omp_get_num_procs() ? report->threads : omp_get_num_procs();
+
+        for (int j = 0; j < njobs; j++) {
+            #pragma omp task firstprivate(j)
+            {
+                jobs[j].start = omp_get_wtime() - t0;
+                jobs[j].run(jobs[j].arg);
+                jobs[j].end = omp_get_wtime() - t0;
+            }
+        }
+        #pragma omp taskwait
+    }
+
+    report->makespan = omp_get_wtime() - t0;
+    report->busy = total_busy();
+}
+
+void job_run_nested(job *jobs, int njobs, int threads, job_report *report) {
+    if (threads <= 0) threads = omp_get_max_threads();
+    int levels = omp_get_max_active_levels();
+    omp_set_max_active_levels(2);
+    reset_busy();
+
+    double t0 = omp_get_wtime();
+
+    #pragma omp parallel num_threads(threads)
+    #pragma omp single
+    {
+        report->threads = omp_get_num_threads();
+        report->cores = report->threads < omp_get_num_procs() ? report->threads : omp_get_num_procs();
+
+        for (int j = 0; j < njobs; j++) {
+            #pragma omp task firstprivate(j)
+            {
+                jobs[j].start = omp_get_wtime() - t0;
+                #pragma omp parallel num_threads(threads)
+                #pragma omp single
+                jobs[j].run(jobs[j].arg);
+                jobs[j].end = omp_get_wtime() - t0;
+            }
+        }
+        #pragma omp taskwait
+    }
+
+    report->makespan = omp_get_wtime() - t0;
+    report->busy = total_busy();
+    omp_set_max_active_levels(levels);
+}
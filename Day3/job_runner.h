@@ -0,0 +1,44 @@
+// Concurrent job runner on one shared task pool
+//
+// concurrent_tasks_demo runs each job as a task that opens its own parallel
+// region: with nesting enabled that oversubscribes the machine, without it
+// every job runs on one thread. Here all jobs share a single team. Each job
+// starts as one task and its kernel creates its subtasks in that same team
+// (orphaned task code, no nested parallel), so idle threads pick up work
+// from whichever job has some.
+//
+// Kernels measure their leaf work with job_cpu_now() and credit it with
+// job_busy_add(). Thread CPU time leaves out time a thread was descheduled,
+// so the sum divided by makespan * cores is the core utilization even when
+// the nested runner oversubscribes.
+
+#ifndef JOB_RUNNER_H
+#define JOB_RUNNER_H
+
+typedef struct {
+    const char *name;
+    void (*run)(void *arg); // called inside a task; may create tasks, must wait for them
+    void *arg;
+    double start, end;      // seconds since the batch was submitted
+} job;
+
+typedef struct {
+    int threads;
+    int cores;   // min(threads, processors)
+    double makespan;
+    double busy; // leaf work CPU seconds, summed over threads
+} job_report;
+
+// Run all jobs concurrently on one team of `threads` (0 = OpenMP default)
+void job_run_all(job *jobs, int njobs, int threads, job_report *report);
+
+// Same jobs, each in its own nested parallel region (the old way)
+void job_run_nested(job *jobs, int njobs, int threads, job_report *report);
+
+// CPU time of the calling thread, in seconds
+double job_cpu_now(void);
+
+// Credit `seconds` of useful work to the calling thread
+void job_busy_add(double seconds);
+
+#endif
@@ -0,0 +1,180 @@
+// Job Runner - Main Program
+//
+// usage: job_runner [job ...]   job = fib:<n> | pi:<log2 slices> | triad:<log2 length>
+//
+// Runs a mixed batch of kernels twice: the concurrent_tasks_demo way with a
+// nested parallel region per job, then all jobs on one shared team, and prints
+// per-job latency, makespan and core utilization for both.
+//
+// The kernels are orphaned task code: they create tasks in whatever team runs
+// them and never open a parallel region of their own.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+
+#include "fibonacci_task_recursion.h"
+#include "job_runner.h"
+
+#define MAX_JOBS 32
+#define PI_CHUNK (1LL << 18)
+#define TRIAD_CHUNK (1L << 16)
+#define TRIAD_REPS 20
+
+static const char *default_jobs[] = {"fib:38", "pi:27", "triad:23", "fib:34", "pi:25", "triad:21"};
+
+typedef struct {
+    char name[24];
+    int kind;   // 0 fib, 1 pi, 2 triad
+    int size;
+    double result;
+    double *a, *b, *c; // triad arrays
+} job_arg;
+
+// ---------------------------------------------------------------------------
+// Kernels
+
+static long fib_job(int n) {
+    if (n <= FIB_CUTOFF) {
+        double c0 = job_cpu_now();
+        long r = fib_sequential(n);
+        job_busy_add(job_cpu_now() - c0);
+        return r;
+    }
+
+    long x, y;
+    #pragma omp task shared(x)
+    x = fib_job(n - 1);
+    y = fib_job(n - 2);
+    #pragma omp taskwait
+    return x + y;
+}
+
+static double pi_job(long long n) {
+    const double step = 1.0 / (double)n;
+    double sum = 0.0;
+
+    #pragma omp taskgroup task_reduction(+:sum)
+    {
+        for (long long start = 0; start < n; start += PI_CHUNK) {
+            long long end = start + PI_CHUNK < n ? start + PI_CHUNK : n;
+
+            #pragma omp task firstprivate(start, end) in_reduction(+:sum)
+            {
+                double c0 = job_cpu_now(), local = 0.0;
+                for (long long i = start; i < end; ++i) {
+                    double x = (i + 0.5) * step;
+                    local += 4.0 / (1.0 + x * x);
+                }
+                sum += local;
+                job_busy_add(job_cpu_now() - c0);
+            }
+        }
+    }
+    return sum * step;
+}
+
+// a = b + s * c, TRIAD_REPS sweeps; memory bound where the others are not
+static double triad_job(double *a, const double *b, const double *c, long n) {
+    for (int r = 0; r < TRIAD_REPS; r++) {
+        const double s = 1.0 + r;
+        for (long start = 0; start < n; start += TRIAD_CHUNK) {
+            long end = start + TRIAD_CHUNK < n ? start + TRIAD_CHUNK : n;
+
+            #pragma omp task firstprivate(start, end)
+            {
+                double c0 = job_cpu_now();
+                for (long i = start; i < end; i++) a[i] = b[i] + s * c[i];
+                job_busy_add(job_cpu_now() - c0);
+            }
+        }
+        #pragma omp taskwait
+    }
+    return a[n - 1];
+}
+
+static void run_job(void *p) {
+    job_arg *arg = p;
+    switch (arg->kind) {
+    case 0: arg->result = (double)fib_job(arg->size); break;
+    case 1: arg->result = pi_job(1LL << arg->size); break;
+    case 2: arg->result = triad_job(arg->a, arg->b, arg->c, 1L << arg->size); break;
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+static int parse_job(const char *spec, job_arg *arg) {
+    static const char *kinds[] = {"fib", "pi", "triad"};
+    const char *colon = strchr(spec, ':');
+    if (!colon) return -1;
+
+    memset(arg, 0, sizeof(*arg));
+    arg->kind = -1;
+    for (int k = 0; k < 3; k++)
+        if ((size_t)(colon - spec) == strlen(kinds[k]) && strncmp(spec, kinds[k], colon - spec) == 0) arg->kind = k;
+    arg->size = atoi(colon + 1);
+    if (arg->kind < 0 || arg->size < 1 || arg->size > (arg->kind == 0 ? 50 : 30)) return -1;
+
+    snprintf(arg->name, sizeof(arg->name), "%s", spec);
+    if (arg->kind == 2) {
+        long n = 1L << arg->size;
+        arg->a = malloc(n * sizeof(double));
+        arg->b = malloc(n * sizeof(double));
+        arg->c = malloc(n * sizeof(double));
+        if (!arg->a || !arg->b || !arg->c) return -1;
+        for (long i = 0; i < n; i++) {
+            arg->a[i] = 0.0;
+            arg->b[i] = 1.0;
+            arg->c[i] = 2.0;
+        }
+    }
+    return 0;
+}
+
+static void print_report(const char *title, const job *jobs, const job_arg *args, int njobs, const job_report *rep) {
+    printf("%s: %d threads\n", title, rep->threads);
+    // Every job is submitted at time 0, so its latency is its end time
+    printf("  %-12s %9s %9s %9s  %s\n", "job", "start", "run", "latency", "result");
+    for (int j = 0; j < njobs; j++)
+        printf("  %-12s %8.3fs %8.3fs %8.3fs  %.10g\n", jobs[j].name, jobs[j].start, jobs[j].end - jobs[j].start,
+               jobs[j].end, args[j].result);
+    printf("  makespan %.3f s, busy %.3f CPU s, utilization %.1f%% of %d cores\n\n", rep->makespan, rep->busy,
+           100.0 * rep->busy / (rep->makespan * rep->cores), rep->cores);
+}
+
+int main(int argc, char **argv) {
+    job_arg args[MAX_JOBS];
+    job jobs[MAX_JOBS];
+    int njobs = 0;
+
+    int nspecs = argc > 1 ? argc - 1 : (int)(sizeof(default_jobs) / sizeof(default_jobs[0]));
+    for (int i = 0; i < nspecs && njobs < MAX_JOBS; i++) {
+        const char *spec = argc > 1 ? argv[i + 1] : default_jobs[i];
+        if (parse_job(spec, &args[njobs]) != 0) {
+            printf("bad job '%s' (expected fib:<n>, pi:<log2 slices> or triad:<log2 length>)\n", spec);
+            return 1;
+        }
+        jobs[njobs] = (job){args[njobs].name, run_job, &args[njobs], 0.0, 0.0};
+        njobs++;
+    }
+
+    job_report rep;
+
+    job_run_nested(jobs, njobs, 0, &rep);
+    print_report("nested team per job", jobs, args, njobs, &rep);
+    double nested = rep.makespan;
+
+    job_run_all(jobs, njobs, 0, &rep);
+    print_report("shared task pool", jobs, args, njobs, &rep);
+
+    printf("shared pool makespan %.2fx of nested\n", rep.makespan / nested);
+
+    for (int j = 0; j < njobs; j++) {
+        free(args[j].a);
+        free(args[j].b);
+        free(args[j].c);
+    }
+    return 0;
+}
@@ -0,0 +1,306 @@
+// Monte Carlo integration engine (see mc_engine.h)
+
+#include "mc_engine.h"
+#include "philox.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <omp.h>
+
+#define MC_BLOCK 4096 // samples per block: the unit of work and of merging
+
+// Stream numbers in the Philox counter: samples of replicate r use stream r,
+// its random shifts use SHIFT_STREAM | r
+#define SHIFT_STREAM 0x80000000u
+
+mc_options mc_default_options(void) {
+    mc_options opt = {MC_PLAIN, 1000000, 16, 0x9e3779b97f4a7c15ULL, 0};
+    return opt;
+}
+
+const char *mc_method_name(mc_method method) {
+    switch (method) {
+    case MC_PLAIN: return "plain";
+    case MC_STRATIFIED: return "stratified";
+    case MC_ANTITHETIC: return "antithetic";
+    case MC_SOBOL: return "sobol";
+    case MC_HALTON: return "halton";
+    }
+    return "?";
+}
+
+// ---------------------------------------------------------------------------
+// Running mean and variance (Welford), merged pairwise (Chan et al.)
+
+typedef struct {
+    long n;
+    double mean, m2;
+} welford;
+
+static void welford_add(welford *w, double x) {
+    w->n++;
+    double d = x - w->mean;
+    w->mean += d / (double)w->n;
+    w->m2 += d * (x - w->mean);
+}
+
+static void welford_merge(welford *a, const welford *b) {
+    if (b->n == 0) return;
+    if (a->n == 0) {
+        *a = *b;
+        return;
+    }
+    long n = a->n + b->n;
+    double d = b->mean - a->mean;
+    a->mean += d * (double)b->n / (double)n;
+    a->m2 += b->m2 + d * d * (double)a->n * (double)b->n / (double)n;
+    a->n = n;
+}
+
+// ---------------------------------------------------------------------------
+// Low-discrepancy sequences
+
+// Joe & Kuo direction numbers (new-joe-kuo-6.21201) for dimensions 2..21:
+// degree s of the primitive polynomial, its coefficients a, initial m_1..m_s.
+// Dimension 1 is the van der Corput sequence in base 2.
+static const struct {
+    int s, a;
+    unsigned m[7];
+} joe_kuo[MC_SOBOL_MAX_DIM - 1] = {
+    {1, 0, {1}},
+    {2, 1, {1, 3}},
+    {3, 1, {1, 3, 1}},
+    {3, 2, {1, 1, 1}},
+    {4, 1, {1, 1, 3, 3}},
+    {4, 4, {1, 3, 5, 13}},
+    {5, 2, {1, 1, 5, 5, 17}},
+    {5, 4, {1, 1, 5, 5, 5}},
+    {5, 7, {1, 1, 7, 11, 19}},
+    {5, 11, {1, 1, 5, 1, 1}},
+    {5, 13, {1, 1, 1, 3, 11}},
+    {5, 14, {1, 3, 5, 5, 31}},
+    {6, 1, {1, 3, 3, 9, 7, 49}},
+    {6, 13, {1, 1, 1, 15, 21, 21}},
+    {6, 16, {1, 3, 1, 13, 27, 49}},
+    {6, 19, {1, 1, 1, 15, 7, 5}},
+    {6, 22, {1, 3, 1, 15, 13, 25}},
+    {6, 25, {1, 1, 5, 5, 19, 61}},
+    {7, 1, {1, 3, 7, 11, 23, 15, 103}},
+    {7, 4, {1, 3, 7, 13, 13, 15, 69}},
+};
+
+// 32-bit direction numbers v[d][k], k = 0..31
+static void sobol_directions(int dim, uint32_t v[][32]) {
+    for (int k = 0; k < 32; k++) v[0][k] = 1u << (31 - k);
+
+    for (int d = 1; d < dim; d++) {
+        int s = joe_kuo[d - 1].s, a = joe_kuo[d - 1].a;
+        for (int k = 0; k < s; k++) v[d][k] = joe_kuo[d - 1].m[k] << (31 - k);
+        for (int k = s; k < 32; k++) {
+            v[d][k] = v[d][k - s] ^ (v[d][k - s] >> s);
+            for (int i = 1; i < s; i++)
+                if ((a >> (s - 1 - i)) & 1) v[d][k] ^= v[d][k - i];
+        }
+    }
+}
+
+static const int primes[MC_MAX_DIM] = {
+    2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53,
+    59, 61, 67, 71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127, 131};
+
+static double radical_inverse(unsigned long long i, int base) {
+    double inv = 1.0 / base, f = inv, r = 0.0;
+    while (i) {
+        r += (double)(i % base) * f;
+        i /= base;
+        f *= inv;
+    }
+    return r;
+}
+
+// ---------------------------------------------------------------------------
+// Sampling
+
+typedef struct {
+    mc_method method;
+    int dim;
+    uint64_t seed;
+    uint32_t stream;
+    int strat_dims, strat_k; // grid of strat_k^strat_dims strata
+    long strata;
+    const uint32_t (*sobol_v)[32];
+    uint32_t shift_bits[MC_MAX_DIM]; // sobol digital shift
+    double shift[MC_MAX_DIM];        // halton shift
+} sampler;
+
+// dim uniforms for sample `index`, two per Philox call
+static void philox_uniforms(uint64_t seed, uint64_t index, uint32_t stream, int dim, double *u) {
+    const uint32_t key[2] = {(uint32_t)seed, (uint32_t)(seed >> 32)};
+    uint32_t r[4];
+
+    for (int j = 0; j < dim; j += 2) {
+        const uint32_t ctr[4] = {(uint32_t)index, (uint32_t)(index >> 32), (uint32_t)(j / 2), stream};
+        philox4x32(ctr, key, r);
+        u[j] = philox_u01(r[0], r[1]);
+        if (j + 1 < dim) u[j + 1] = philox_u01(r[2], r[3]);
+    }
+}
+
+// Largest grid k^s <= n over the first s dimensions, preferring all of them
+static void choose_strata(int dim, long n, int *s, int *k) {
+    *s = dim;
+    *k = 1;
+    for (int dims = dim; dims >= 1; dims--) {
+        int kk = (int)floor(pow((double)n, 1.0 / dims) + 1e-9);
+        while (kk > 1 && pow((double)kk, dims) > (double)n) kk--;
+        if (kk >= 2) {
+            *s = dims;
+            *k = kk;
+            return;
+        }
+    }
+}
+
+// Samples [first, last) of one replicate into w
+static void run_block(const sampler *sp, mc_integrand f, void *ctx, long first, long last, welford *w) {
+    const int dim = sp->dim;
+    double x[MC_MAX_DIM];
+
+    switch (sp->method) {
+    case MC_PLAIN:
+        for (long j = first; j < last; j++) {
+            philox_uniforms(sp->seed, j, sp->stream, dim, x);
+            welford_add(w, f(x, dim, ctx));
+        }
+        break;
+
+    case MC_ANTITHETIC:
+        for (long j = first; j < last; j++) {
+            double xa[MC_MAX_DIM];
+            philox_uniforms(sp->seed, j, sp->stream, dim, x);
+            for (int i = 0; i < dim; i++) xa[i] = 1.0 - x[i];
+            welford_add(w, 0.5 * (f(x, dim, ctx) + f(xa, dim, ctx)));
+        }
+        break;
+
+    case MC_STRATIFIED:
+        for (long j = first; j < last; j++) {
+            long cell = j % sp->strata;
+            philox_uniforms(sp->seed, j, sp->stream, dim, x);
+            for (int i = 0; i < sp->strat_dims; i++) {
+                x[i] = ((double)(cell % sp->strat_k) + x[i]) / sp->strat_k;
+                cell /= sp->strat_k;
+            }
+            welford_add(w, f(x, dim, ctx));
+        }
+        break;
+
+    case MC_SOBOL: {
+        // Gray-code order: point j differs from point j-1 in the direction
+        // number of the lowest set bit of j, so only the block start is
+        // computed from scratch
+        uint32_t state[MC_SOBOL_MAX_DIM] = {0};
+        uint32_t gray = (uint32_t)first ^ ((uint32_t)first >> 1);
+        for (int k = 0; gray; k++, gray >>= 1)
+            if (gray & 1)
+                for (int i = 0; i < dim; i++) state[i] ^= sp->sobol_v[i][k];
+
+        for (long j = first; j < last; j++) {
+            if (j > first) {
+                int k = __builtin_ctz((uint32_t)j);
+                for (int i = 0; i < dim; i++) state[i] ^= sp->sobol_v[i][k];
+            }
+            for (int i = 0; i < dim; i++)
+                x[i] = (double)(state[i] ^ sp->shift_bits[i]) * (1.0 / 4294967296.0);
+            welford_add(w, f(x, dim, ctx));
+        }
+        break;
+    }
+
+    case MC_HALTON:
+        for (long j = first; j < last; j++) {
+            for (int i = 0; i < dim; i++) {
+                double v = radical_inverse((unsigned long long)j, primes[i]) + sp->shift[i];
+                x[i] = v >= 1.0 ? v - 1.0 : v;
+            }
+            welford_add(w, f(x, dim, ctx));
+        }
+        break;
+    }
+}
+
+int mc_integrate(mc_integrand f, void *ctx, int dim, const mc_options *opt, mc_result *result) {
+    if (dim < 1 || dim > MC_MAX_DIM) return -1;
+    if (opt->method == MC_SOBOL && dim > MC_SOBOL_MAX_DIM) return -1;
+
+    const int replicates = opt->replicates > 0 ? opt->replicates : 1;
+    const int threads = opt->num_threads > 0 ? opt->num_threads : omp_get_max_threads();
+    long per_rep = opt->evaluations / replicates;
+    if (per_rep < 1) per_rep = 1;
+
+    static uint32_t sobol_v[MC_SOBOL_MAX_DIM][32];
+    if (opt->method == MC_SOBOL) {
+        if (per_rep > 0xffffffffL) per_rep = 0xffffffffL; // 32-bit direction numbers
+        sobol_directions(dim, sobol_v);
+    }
+
+    sampler sp = {opt->method, dim, opt->seed, 0, 0, 1, 1, (const uint32_t(*)[32])sobol_v, {0}, {0}};
+
+    // Samples per replicate, and evaluations per sample
+    long samples = per_rep;
+    int evals_per_sample = 1;
+    if (opt->method == MC_ANTITHETIC) {
+        samples = per_rep / 2 > 0 ? per_rep / 2 : 1;
+        evals_per_sample = 2;
+    } else if (opt->method == MC_STRATIFIED) {
+        choose_strata(dim, per_rep, &sp.strat_dims, &sp.strat_k);
+        sp.strata = 1;
+        for (int i = 0; i < sp.strat_dims; i++) sp.strata *= sp.strat_k;
+        samples = per_rep / sp.strata * sp.strata; // equal allocation
+    }
+
+    const long nblocks = (samples + MC_BLOCK - 1) / MC_BLOCK;
+    welford *blocks = malloc(nblocks * sizeof(welford));
+    if (!blocks) return -1;
+
+    welford pooled = {0, 0.0, 0.0}, reps = {0, 0.0, 0.0};
+    double t0 = omp_get_wtime();
+
+    for (int r = 0; r < replicates; r++) {
+        sp.stream = (uint32_t)r;
+        double u[MC_MAX_DIM];
+        philox_uniforms(opt->seed, 0, SHIFT_STREAM | (uint32_t)r, dim, u);
+        for (int i = 0; i < dim; i++) {
+            sp.shift[i] = u[i];
+            sp.shift_bits[i] = (uint32_t)(u[i] * 4294967296.0);
+        }
+
+        #pragma omp parallel for schedule(static) num_threads(threads)
+        for (long b = 0; b < nblocks; b++) {
+            long first = b * MC_BLOCK;
+            long last = first + MC_BLOCK < samples ? first + MC_BLOCK : samples;
+            welford w = {0, 0.0, 0.0};
+            run_block(&sp, f, ctx, first, last, &w);
+            blocks[b] = w;
+        }
+
+        // Fixed merge order, whatever the thread count
+        welford rep = {0, 0.0, 0.0};
+        for (long b = 0; b < nblocks; b++) welford_merge(&rep, &blocks[b]);
+        welford_merge(&pooled, &rep);
+        welford_add(&reps, rep.mean);
+    }
+
+    result->seconds = omp_get_wtime() - t0;
+    free(blocks);
+
+    result->value = reps.mean;
+    result->evaluations = (long)replicates * samples * evals_per_sample;
+    if (opt->method == MC_PLAIN || opt->method == MC_ANTITHETIC) {
+        result->std_error = pooled.n > 1 ? sqrt(pooled.m2 / (pooled.n - 1) / pooled.n) : 0.0;
+    } else {
+        result->std_error = reps.n > 1 ? sqrt(reps.m2 / (reps.n - 1) / reps.n) : INFINITY;
+    }
+    return 0;
+}
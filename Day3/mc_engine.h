@@ -0,0 +1,62 @@
+// Monte Carlo integration engine
+//
+// Integrates f(x) over the unit cube [0, 1]^d, built on the counter-based
+// generator from flat_monte_carlo.c (philox.h). Sampling methods:
+//
+//   plain       independent uniform points
+//   stratified  jittered grid: one cell per stratum over the leading
+//               dimensions, a uniform point inside each cell
+//   antithetic  pairs u and 1 - u, each pair averaged into one sample
+//   sobol       Sobol sequence (Joe-Kuo direction numbers), random digital shift
+//   halton      Halton sequence, random Cranley-Patterson shift
+//
+// Every method runs `replicates` independent randomizations. Plain and
+// antithetic samples are i.i.d., so their error bar is the sample standard
+// error; the others are correlated inside a replicate, so their error bar
+// comes from the spread of the replicate estimates.
+//
+// Samples are processed in fixed blocks whose Welford accumulators are merged
+// in block order, so results are bit-identical at any thread count.
+
+#ifndef MC_ENGINE_H
+#define MC_ENGINE_H
+
+#define MC_MAX_DIM 32
+#define MC_SOBOL_MAX_DIM 21
+
+typedef double (*mc_integrand)(const double *x, int dim, void *ctx);
+
+typedef enum {
+    MC_PLAIN,
+    MC_STRATIFIED,
+    MC_ANTITHETIC,
+    MC_SOBOL,
+    MC_HALTON,
+} mc_method;
+
+#define MC_NUM_METHODS 5
+
+typedef struct {
+    mc_method method;
+    long evaluations;        // integrand evaluations, split over the replicates
+    int replicates;          // independent randomizations (>= 2 for error bars)
+    unsigned long long seed;
+    int num_threads;         // 0 = OpenMP default
+} mc_options;
+
+typedef struct {
+    double value;
+    double std_error;
+    long evaluations;        // evaluations actually made
+    double seconds;
+} mc_result;
+
+// Default options: plain sampling, 10^6 evaluations, 16 replicates
+mc_options mc_default_options(void);
+
+const char *mc_method_name(mc_method method);
+
+// Returns 0 on success, -1 if dim is out of range for the method
+int mc_integrate(mc_integrand f, void *ctx, int dim, const mc_options *opt, mc_result *result);
+
+#endif
@@ -0,0 +1,106 @@
+// Monte Carlo Engine - Main Program
+//
+// Integrates two d-dimensional test functions on [0, 1]^d with every sampling
+// method at the same number of evaluations, then finds how many evaluations
+// (and how much wall time) each method needs to reach a target error bar.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <omp.h>
+
+#include "mc_engine.h"
+
+#define PI 3.14159265358979323846
+#define DIM 8
+#define EVALUATIONS (1L << 20)
+#define TARGET_ERROR 1e-4
+#define MAX_EVALUATIONS (1L << 28)
+
+// Sobol' g-function: product of (|4x - 2| + a_i) / (1 + a_i), integral 1.
+// Small a_i make a dimension important; here a_i = i.
+static double g_function(const double *x, int dim, void *ctx) {
+    (void)ctx;
+    double p = 1.0;
+    for (int i = 0; i < dim; i++) p *= (fabs(4.0 * x[i] - 2.0) + i) / (1.0 + i);
+    return p;
+}
+
+// exp(-|x|^2), integral (sqrt(pi)/2 erf(1))^d
+static double gaussian(const double *x, int dim, void *ctx) {
+    (void)ctx;
+    double r2 = 0.0;
+    for (int i = 0; i < dim; i++) r2 += x[i] * x[i];
+    return exp(-r2);
+}
+
+static void compare(const char *title, mc_integrand f, double exact, int dim, long evaluations, int replicates) {
+    printf("%s, d=%d, exact %.10f\n", title, dim, exact);
+    printf("%-11s %14s %10s %10s %7s %10s %8s\n", "method", "value", "error", "std err", "err/se", "evals", "time");
+
+    for (int m = 0; m < MC_NUM_METHODS; m++) {
+        mc_options opt = mc_default_options();
+        mc_result res;
+        opt.method = (mc_method)m;
+        opt.evaluations = evaluations;
+        opt.replicates = replicates;
+
+        if (mc_integrate(f, NULL, dim, &opt, &res) != 0) {
+            printf("%-11s (d=%d not supported)\n", mc_method_name(opt.method), dim);
+            continue;
+        }
+        double err = fabs(res.value - exact);
+        printf("%-11s %14.10f %10.2e %10.2e %7.2f %10ld %7.3fs\n", mc_method_name(opt.method),
+               res.value, err, res.std_error, err / res.std_error, res.evaluations, res.seconds);
+    }
+    printf("\n");
+}
+
+// Doubles the evaluation count until the error bar is below target
+static void time_to_accuracy(const char *title, mc_integrand f, int dim, int replicates, double target) {
+    printf("%s, d=%d: evaluations to reach std err <= %.0e\n", title, dim, target);
+    printf("%-11s %12s %10s %10s\n", "method", "evals", "std err", "time");
+
+    for (int m = 0; m < MC_NUM_METHODS; m++) {
+        mc_options opt = mc_default_options();
+        mc_result res = {0.0, INFINITY, 0, 0.0};
+        double total = 0.0;
+        opt.method = (mc_method)m;
+        opt.replicates = replicates;
+
+        for (long n = 1L << 14; n <= MAX_EVALUATIONS; n *= 2) {
+            opt.evaluations = n;
+            if (mc_integrate(f, NULL, dim, &opt, &res) != 0) break;
+            total += res.seconds;
+            if (res.std_error <= target) break;
+        }
+
+        if (res.std_error <= target)
+            printf("%-11s %12ld %10.2e %9.3fs\n", mc_method_name(opt.method), res.evaluations, res.std_error, total);
+        else
+            printf("%-11s %12s\n", mc_method_name(opt.method), "not reached");
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv) {
+    int dim = argc > 1 ? atoi(argv[1]) : DIM;
+    long evaluations = argc > 2 ? atol(argv[2]) : EVALUATIONS;
+    int replicates = argc > 3 ? atoi(argv[3]) : mc_default_options().replicates;
+
+    if (dim < 1 || dim > MC_MAX_DIM || evaluations < 1 || replicates < 2) {
+        printf("usage: %s [dim 1..%d] [evaluations] [replicates >= 2]\n", argv[0], MC_MAX_DIM);
+        return 1;
+    }
+
+    printf("Monte Carlo engine: %d threads, %d replicates\n\n", omp_get_max_threads(), replicates);
+
+    double gauss_exact = pow(0.5 * sqrt(PI) * erf(1.0), dim);
+
+    compare("g-function", g_function, 1.0, dim, evaluations, replicates);
+    compare("gaussian", gaussian, gauss_exact, dim, evaluations, replicates);
+
+    time_to_accuracy("g-function", g_function, dim, replicates, TARGET_ERROR);
+    time_to_accuracy("gaussian", gaussian, dim, replicates, TARGET_ERROR);
+    return 0;
+}
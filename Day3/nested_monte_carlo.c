@@ -1,79 +1,155 @@
 // pi_nested_input.c
+//
+// Two-level Monte Carlo pi: `outer` workers each own a persistent inner team
+// of `inner` threads. The workers claim chunks of the sample range
+// concurrently from a shared atomic counter; the inner team splits each chunk
+// with an omp for. Chunk sizes follow guided decay - remaining / (GUIDED_K *
+// outer), never below MIN_CHUNK - so early claims are large and the tail is
+// fine-grained enough to balance.
+//
+// The same points are then counted by a flat team of outer * inner threads
+// for comparison.
 #include <stdio.h>
 #include <stdlib.h>
 #include <omp.h>
 
+#include "philox.h"
+
 #ifndef OUTER_T
 #define OUTER_T 2
 #endif
 #ifndef INNER_T
 #define INNER_T 4
 #endif
-#ifndef CHUNK
-#define CHUNK (1ULL<<22)
+#ifndef MIN_CHUNK
+#define MIN_CHUNK (1ULL<<16)
+#endif
+#ifndef GUIDED_K
+#define GUIDED_K 2
 #endif
 
-// small xorshift rng
-static inline unsigned xorshift32(unsigned *s){
-    unsigned x = *s;
-    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
-    return *s = x ? x : 2463534242u;
-}
-static inline double urand(unsigned *s){
-    return (xorshift32(s) >> 8) * (1.0/16777216.0);
-}
+#define MAX_OUTER 64
 
-int main(int argc, char **argv){
-    if(argc < 2){
-        printf("usage: %s <num_points>\n", argv[0]);
-        return 1;
+// Same counter-based stream as flat_monte_carlo.c: point i is a function of
+// (SEED, i) only, so both programs count exactly the same points
+#define SEED 0x9e3779b97f4a7c15ULL
+#define BATCH 1024
+
+// Points first .. first+count-1 inside the unit circle
+static unsigned long long count_batch(unsigned long long first, int count){
+    double xs[BATCH], ys[BATCH];
+    unsigned long long local = 0;
+
+    philox_fill_points(SEED, first, count, xs, ys);
+    #pragma omp simd reduction(+:local)
+    for(int i=0;i<count;i++){
+        local += (xs[i]*xs[i] + ys[i]*ys[i] <= 1.0);
     }
-    unsigned long long NPTS = strtoull(argv[1], NULL, 10);
-    omp_set_nested(1);
-    omp_set_max_active_levels(2);
+    return local;
+}
 
-    unsigned long long total_inside = 0, total_points = 0;
-    double t0 = omp_get_wtime();
+// Claim the next chunk, returns its size (0 when the range is exhausted)
+static unsigned long long claim_chunk(unsigned long long *next, unsigned long long npts,
+                                      int outer, unsigned long long *start){
+    unsigned long long seen, size;
+
+    // A stale read only makes the chunk a little off its guided size; the
+    // fetch-and-add below is what keeps the claimed ranges disjoint
+    #pragma omp atomic read
+    seen = *next;
+    if(seen >= npts) return 0;
+
+    size = (npts - seen) / ((unsigned long long)GUIDED_K * outer);
+    size = (size + BATCH - 1) / BATCH * BATCH;
+    if(size < MIN_CHUNK) size = MIN_CHUNK;
+
+    #pragma omp atomic capture
+    { *start = *next; *next += size; }
+    if(*start >= npts) return 0;
+    return (*start + size > npts) ? npts - *start : size;
+}
+
+static unsigned long long nested_count(unsigned long long npts, int outer, int inner,
+                                       int chunks[MAX_OUTER]){
+    unsigned long long next = 0, total_inside = 0;
 
-    #pragma omp parallel num_threads(OUTER_T)
+    #pragma omp parallel num_threads(outer)
     {
-        #pragma omp single
+        int worker = omp_get_thread_num();
+        int claimed = 0;
+        unsigned long long worker_inside = 0;
+
+        // One inner team per worker, alive for all of its chunks
+        #pragma omp parallel num_threads(inner) reduction(+:worker_inside)
         {
-            static unsigned long long next = 0;
             for(;;){
-                unsigned long long start, count = CHUNK;
-                #pragma omp atomic capture
-                { start = next; next += CHUNK; }
-                if(start >= NPTS) break;
-                if(start + count > NPTS) count = NPTS - start;
+                unsigned long long start = 0, count = 0;
 
-                #pragma omp parallel num_threads(INNER_T)
+                #pragma omp single copyprivate(start, count)
                 {
-                    unsigned long long local = 0;
-                    unsigned seed = 0x9e3779b9u
-                                  ^ (unsigned)omp_get_thread_num()
-                                  ^ (unsigned)(start & 0xffffffffu);
-
-                    #pragma omp for schedule(static)
-                    for(unsigned long long i=0;i<count;i++){
-                        double x = urand(&seed);
-                        double y = urand(&seed);
-                        if(x*x + y*y <= 1.0) local++;
-                    }
-                    #pragma omp atomic
-                    total_inside += local;
+                    count = claim_chunk(&next, npts, outer, &start);
+                    if(count) claimed++;
                 }
+                if(count == 0) break;
 
-                #pragma omp atomic
-                total_points += count;
+                unsigned long long nbatches = (count + BATCH - 1) / BATCH;
+                #pragma omp for schedule(static)
+                for(unsigned long long b=0;b<nbatches;b++){
+                    unsigned long long first = b * BATCH;
+                    int n = (count - first < BATCH) ? (int)(count - first) : BATCH;
+                    worker_inside += count_batch(start + first, n);
+                }
             }
         }
+        chunks[worker] = claimed;
+        #pragma omp atomic
+        total_inside += worker_inside;
     }
+    return total_inside;
+}
 
+static unsigned long long flat_count(unsigned long long npts, int threads){
+    unsigned long long inside = 0;
+    unsigned long long nbatches = (npts + BATCH - 1) / BATCH;
+
+    #pragma omp parallel for schedule(static) num_threads(threads) reduction(+:inside)
+    for(unsigned long long b=0;b<nbatches;b++){
+        unsigned long long first = b * BATCH;
+        int n = (npts - first < BATCH) ? (int)(npts - first) : BATCH;
+        inside += count_batch(first, n);
+    }
+    return inside;
+}
+
+int main(int argc, char **argv){
+    if(argc < 2){
+        printf("usage: %s <num_points> [outer] [inner]\n", argv[0]);
+        return 1;
+    }
+    unsigned long long NPTS = strtoull(argv[1], NULL, 10);
+    int outer = argc > 2 ? atoi(argv[2]) : OUTER_T;
+    int inner = argc > 3 ? atoi(argv[3]) : INNER_T;
+    if(outer < 1) outer = 1;
+    if(outer > MAX_OUTER) outer = MAX_OUTER;
+    if(inner < 1) inner = 1;
+    omp_set_max_active_levels(2);
+
+    int chunks[MAX_OUTER] = {0};
+
+    double t0 = omp_get_wtime();
+    unsigned long long nested_inside = nested_count(NPTS, outer, inner, chunks);
     double t1 = omp_get_wtime();
-    double pi = 4.0 * (double)total_inside / (double)total_points;
-    printf("nested: pi=%.6f time=%.3fs outer=%d inner=%d chunk=%llu npts=%llu\n",
-           pi, t1-t0, OUTER_T, INNER_T,
-           (unsigned long long)CHUNK, (unsigned long long)NPTS);
+    unsigned long long flat_inside = flat_count(NPTS, outer * inner);
+    double t2 = omp_get_wtime();
+
+    printf("nested: pi=%.6f inside=%llu time=%.3fs outer=%d inner=%d min_chunk=%llu npts=%llu\n",
+           4.0 * (double)nested_inside / (double)NPTS, nested_inside, t1-t0, outer, inner,
+           (unsigned long long)MIN_CHUNK, (unsigned long long)NPTS);
+    printf("        chunks per worker:");
+    for(int w=0;w<outer;w++) printf(" %d", chunks[w]);
+    printf("\n");
+    printf("flat:   pi=%.6f inside=%llu time=%.3fs threads=%d (nested/flat %.2fx)\n",
+           4.0 * (double)flat_inside / (double)NPTS, flat_inside, t2-t1, outer * inner,
+           (t1-t0) / (t2-t1));
     return 0;
 }
@@ -0,0 +1,86 @@
+// Philox4x32-10 counter-based random number generator
+// (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3", SC11)
+//
+// A counter-based generator has no state to carry from one number to the
+// next: the random bits for sample i are a pure function of (i, seed). Every
+// thread can jump straight to its own samples, streams never overlap, and the
+// numbers a sample sees do not depend on which thread drew it or how many
+// threads there are - so Monte Carlo results are bit-identical at any thread
+// count.
+//
+// Each call turns a 128-bit counter and a 64-bit key into 128 random bits,
+// enough for one (x, y) pair with 53 random bits per coordinate.
+
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <stdint.h>
+
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+
+#ifndef PHILOX_ROUNDS
+#define PHILOX_ROUNDS 10
+#endif
+
+static inline void philox4x32(const uint32_t ctr[4], const uint32_t key[2], uint32_t out[4]) {
+    uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+    uint32_t k0 = key[0], k1 = key[1];
+
+    for (int r = 0; r < PHILOX_ROUNDS; r++) {
+        uint64_t p0 = (uint64_t)PHILOX_M0 * c0;
+        uint64_t p1 = (uint64_t)PHILOX_M1 * c2;
+        c0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+        c1 = (uint32_t)p1;
+        c2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+        c3 = (uint32_t)p0;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+// 53 random bits from two 32-bit words (26 + 27), as a double in [0, 1).
+// Both halves fit in an int32, and int32 -> double conversion vectorizes on
+// every x86-64 CPU, unlike a 64-bit integer conversion.
+static inline double philox_u01(uint32_t hi, uint32_t lo) {
+    return (double)(int32_t)(hi >> 6) * (1.0 / 67108864.0)
+         + (double)(int32_t)(lo >> 5) * (1.0 / 9007199254740992.0);
+}
+
+// The (x, y) point for sample `index` of the stream selected by `seed`
+static inline void philox_point(uint64_t seed, uint64_t index, double *x, double *y) {
+    const uint32_t ctr[4] = {(uint32_t)index, (uint32_t)(index >> 32), 0, 0};
+    const uint32_t key[2] = {(uint32_t)seed, (uint32_t)(seed >> 32)};
+    uint32_t r[4];
+
+    philox4x32(ctr, key, r);
+    *x = philox_u01(r[0], r[1]);
+    *y = philox_u01(r[2], r[3]);
+}
+
+// With GCC on x86-64 Linux the batch fill is compiled for the x86-64-v4
+// (AVX-512), x86-64-v3 (AVX2) and baseline SSE2 levels, and the dynamic loader
+// picks the widest one the CPU supports
+#if defined(__x86_64__) && defined(__linux__) && defined(__GNUC__) && !defined(__clang__)
+#define PHILOX_TARGET_CLONES __attribute__((target_clones("arch=x86-64-v4", "arch=x86-64-v3", "default")))
+#else
+#define PHILOX_TARGET_CLONES
+#endif
+
+// Points first .. first+count-1 into x[] and y[]. There is no dependency
+// between iterations, so the whole batch vectorizes.
+PHILOX_TARGET_CLONES static inline void philox_fill_points(uint64_t seed, uint64_t first, int count, double *x, double *y) {
+    #pragma omp simd
+    for (int i = 0; i < count; i++) {
+        philox_point(seed, first + (uint64_t)i, &x[i], &y[i]);
+    }
+}
+
+#endif
@@ -0,0 +1,58 @@
+// Riemann Sum Reduction Benchmark - Main Program
+//
+// Times the four ways riemann_sum_tasks.c combines per-task partial sums
+// (atomic, task_reduction, taskloop reduction, padded slots) at 1, 2, 4, ...
+// threads up to the number of processors.
+
+#include <math.h>
+#include <stdio.h>
+#include <omp.h>
+
+#define PI_REF 3.14159265358979323846
+
+// Function declarations
+double compute_pi_riemann_task();
+double compute_pi_riemann_task_reduction();
+double compute_pi_riemann_taskloop();
+double compute_pi_riemann_padded();
+
+typedef struct {
+    const char *name;
+    double (*compute)(void);
+} variant;
+
+int main() {
+    const variant variants[] = {
+        {"atomic", compute_pi_riemann_task},
+        {"task_reduction", compute_pi_riemann_task_reduction},
+        {"taskloop", compute_pi_riemann_taskloop},
+        {"padded", compute_pi_riemann_padded},
+    };
+    const int num_variants = sizeof(variants) / sizeof(variants[0]);
+    int max_threads = omp_get_num_procs();
+
+    printf("%-8s %-16s %-10s %-10s %-10s\n", "Threads", "Variant", "Time (s)", "Speedup", "Error");
+
+    double base_time[num_variants];
+
+    // 1, 2, 4, ... and finally max_threads itself if it is not a power of two
+    for (int threads = 1;; threads *= 2) {
+        if (threads > max_threads) threads = max_threads;
+        omp_set_num_threads(threads);
+
+        for (int v = 0; v < num_variants; v++) {
+            double t0 = omp_get_wtime();
+            double pi = variants[v].compute();
+            double t1 = omp_get_wtime();
+
+            if (threads == 1) base_time[v] = t1 - t0;
+
+            printf("%-8d %-16s %-10.4f %-10.2f %-10.2e\n", threads, variants[v].name,
+                   t1 - t0, base_time[v] / (t1 - t0), fabs(pi - PI_REF));
+        }
+
+        if (threads == max_threads) break;
+    }
+
+    return 0;
+}
@@ -13,6 +13,13 @@
 // - Tasks use atomic operations to safely update the global sum
 // - taskwait ensures all tasks complete before final calculation
 //
+// The atomic version makes every task do a compare-and-swap loop on the same
+// cache line. Three alternatives combine the partial sums without that:
+// - compute_pi_riemann_task_reduction: taskgroup task_reduction + in_reduction
+// - compute_pi_riemann_taskloop:       taskloop reduction
+// - compute_pi_riemann_padded:         one cache-line padded slot per thread
+// riemann_reduction_bench.c times all four at 1 to N threads.
+//
 // compile:  gcc -fopenmp taskwait.c -o taskwait
 //           clang -fopenmp taskwait.c -o taskwait
 // run:      OMP_NUM_THREADS=8 ./taskwait
@@ -20,10 +27,25 @@
 #include <stdio.h>
 #include <omp.h>
 
+#define MAX_THREADS 256
+#define CACHE_LINE_SIZE 64
+#define PAD (CACHE_LINE_SIZE / sizeof(double))
+
+static const long long N = 1LL << 28;   // ~268M slices
+static const int CHUNK = 1 << 18;       // ~262k per task
+
+// Midpoint sum of one chunk of slices
+static double riemann_chunk(long long start, long long end, double step) {
+    double local = 0.0;
+    for (long long i = start; i < end; ++i) {
+        double x = (i + 0.5) * step;
+        local += 4.0 / (1.0 + x * x);
+    }
+    return local;
+}
+
 // Entry point function that can be called as a task
 double compute_pi_riemann_task() {
-    const long long N = 1LL << 28;   // ~268M slices 
-    const int CHUNK = 1 << 18;       // ~262k per task
     const double step = 1.0 / (double)N;
 
     double sum = 0.0;
@@ -51,3 +73,73 @@ double compute_pi_riemann_task() {
 
     return sum * step;
 }
+
+// Task reduction: every task gets a private copy of sum, the runtime combines
+// the copies when the taskgroup ends
+double compute_pi_riemann_task_reduction() {
+    const double step = 1.0 / (double)N;
+
+    double sum = 0.0;
+
+    #pragma omp parallel
+    #pragma omp single
+    {
+        #pragma omp taskgroup task_reduction(+:sum)
+        {
+            for (long long start = 0; start < N; start += CHUNK) {
+                long long end = (start + CHUNK < N) ? (start + CHUNK) : N;
+
+                #pragma omp task firstprivate(start, end) in_reduction(+:sum)
+                sum += riemann_chunk(start, end, step);
+            }
+        }
+    }
+
+    return sum * step;
+}
+
+// Taskloop reduction: same chunking, the loop construct creates the tasks
+double compute_pi_riemann_taskloop() {
+    const double step = 1.0 / (double)N;
+
+    double sum = 0.0;
+
+    #pragma omp parallel
+    #pragma omp single
+    #pragma omp taskloop reduction(+:sum) grainsize(1)
+    for (long long start = 0; start < N; start += CHUNK) {
+        long long end = (start + CHUNK < N) ? (start + CHUNK) : N;
+        sum += riemann_chunk(start, end, step);
+    }
+
+    return sum * step;
+}
+
+// Per-thread padded slots: a task adds into the slot of the thread running
+// it. Tasks are tied and the add is not a scheduling point, so two tasks never
+// update the same slot at the same time.
+double compute_pi_riemann_padded() {
+    const double step = 1.0 / (double)N;
+
+    double slots[MAX_THREADS * PAD] = {0};
+    int nthreads = 1;
+
+    #pragma omp parallel
+    #pragma omp single
+    {
+        nthreads = omp_get_num_threads();
+
+        for (long long start = 0; start < N; start += CHUNK) {
+            long long end = (start + CHUNK < N) ? (start + CHUNK) : N;
+
+            #pragma omp task firstprivate(start, end) shared(slots)
+            slots[(omp_get_thread_num() % MAX_THREADS) * PAD] += riemann_chunk(start, end, step);
+        }
+        #pragma omp taskwait
+    }
+
+    double sum = 0.0;
+    for (int t = 0; t < nthreads && t < MAX_THREADS; t++) sum += slots[t * PAD];
+
+    return sum * step;
+}
@@ -0,0 +1,247 @@
+// Task Overhead Micro-benchmarks
+//
+// usage: task_bench [out.csv] [max_threads]
+//
+// Measures what an OpenMP task costs, for 1, 2, 4, ... up to max_threads:
+//
+//   spawn         creating one empty task (the task construct only), in
+//                 batches of SPAWN_BATCH so the runtime never throttles them
+//   spawn_run     creating, running and waiting for one empty task
+//   taskwait      one empty child task + taskwait, per round trip
+//   taskwait_none taskwait with no children
+//   taskgroup     taskgroup around one empty child task, per round trip
+//   depend_chain  per task, tasks chained by depend(inout: x)
+//   depend_indep  per task, depend(inout) on a distinct element each
+//   grain_eff     efficiency of splitting a fixed loop into tasks of `param`
+//                 iterations: sequential time / (task time * threads)
+//   min_grain     smallest grain reaching MIN_EFFICIENCY (param, 0 = none)
+//                 and its sequential run time
+//
+// Every time is the best of REPS runs, in nanoseconds per operation. The
+// OpenMP runtime (libgomp or LLVM libomp) is detected at run time and
+// written into every CSV row, so files from both can be concatenated.
+
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <omp.h>
+
+#define REPS 5
+#define SPAWN_TASKS 100000
+// Tasks created per taskwait. libgomp runs new tasks immediately in the
+// creating thread once more than 64 per thread are queued, which would time
+// inline execution instead of task creation.
+#define SPAWN_BATCH 32
+#define ROUND_TRIPS 50000
+#define DEPEND_TASKS 50000 // at most SPAWN_TASKS
+#define GRAIN_WORK (1L << 24) // loop iterations split into tasks
+#define MIN_EFFICIENCY 0.9
+
+static const char *runtime;
+static FILE *csv;
+
+static const char *detect_runtime(void) {
+    if (dlsym(RTLD_DEFAULT, "__kmpc_fork_call")) return "libomp";
+    if (dlsym(RTLD_DEFAULT, "GOMP_parallel")) return "libgomp";
+    return "unknown";
+}
+
+static void emit(int threads, const char *bench, long param, double value, const char *unit) {
+    fprintf(csv, "%s,%d,%s,%ld,%.3f,%s\n", runtime, threads, bench, param, value, unit);
+    printf("%-8s %3d  %-14s %9ld %12.1f %s\n", runtime, threads, bench, param, value, unit);
+}
+
+// Tasks write their own flag: an empty task body could be compiled away
+static char flags[SPAWN_TASKS];
+
+// Work that the compiler cannot drop
+static double work(long iters) {
+    double x = 0.0;
+    for (long i = 0; i < iters; i++) x = x * 0.999999 + 1.0;
+    return x;
+}
+
+// Results of the timed work; volatile so it is computed, never read
+static volatile double sink;
+
+// ---------------------------------------------------------------------------
+
+static double bench_spawn(int threads, double *spawn_run) {
+    double best_spawn = 1e30, best_total = 1e30;
+
+    for (int r = 0; r < REPS; r++) {
+        double spawn = 0.0, total = 0.0;
+        #pragma omp parallel num_threads(threads)
+        #pragma omp single
+        {
+            double t0 = omp_get_wtime();
+            for (int b = 0; b < SPAWN_TASKS; b += SPAWN_BATCH) {
+                double t1 = omp_get_wtime();
+                for (int i = b; i < b + SPAWN_BATCH && i < SPAWN_TASKS; i++) {
+                    #pragma omp task
+                    flags[i] = 1;
+                }
+                spawn += omp_get_wtime() - t1;
+                #pragma omp taskwait
+            }
+            total = omp_get_wtime() - t0;
+        }
+        if (spawn < best_spawn) best_spawn = spawn;
+        if (total < best_total) best_total = total;
+    }
+
+    *spawn_run = best_total / SPAWN_TASKS * 1e9;
+    return best_spawn / SPAWN_TASKS * 1e9;
+}
+
+// mode 0: task + taskwait, 1: taskwait alone, 2: taskgroup { task }
+static double bench_round_trip(int threads, int mode) {
+    double best = 1e30;
+
+    for (int r = 0; r < REPS; r++) {
+        double t0 = 0.0, t1 = 0.0;
+        #pragma omp parallel num_threads(threads)
+        #pragma omp single
+        {
+            t0 = omp_get_wtime();
+            for (int i = 0; i < ROUND_TRIPS; i++) {
+                if (mode == 0) {
+                    #pragma omp task
+                    flags[0] = 1;
+                    #pragma omp taskwait
+                } else if (mode == 1) {
+                    #pragma omp taskwait
+                } else {
+                    #pragma omp taskgroup
+                    {
+                        #pragma omp task
+                        flags[0] = 1;
+                    }
+                }
+            }
+            t1 = omp_get_wtime();
+        }
+        if (t1 - t0 < best) best = t1 - t0;
+    }
+    return best / ROUND_TRIPS * 1e9;
+}
+
+// chain != 0: every task depends on the previous one through x;
+// otherwise each task has its own dependence address
+static double bench_depend(int threads, int chain) {
+    double best = 1e30;
+
+    for (int r = 0; r < REPS; r++) {
+        double t0 = 0.0, t1 = 0.0;
+        char x = 0;
+        #pragma omp parallel num_threads(threads)
+        #pragma omp single
+        {
+            t0 = omp_get_wtime();
+            for (int i = 0; i < DEPEND_TASKS; i++) {
+                char *dep = chain ? &x : &flags[i];
+                #pragma omp task depend(inout: dep[0])
+                dep[0] = 1;
+            }
+            #pragma omp taskwait
+            t1 = omp_get_wtime();
+        }
+        if (t1 - t0 < best) best = t1 - t0;
+    }
+    return best / DEPEND_TASKS * 1e9;
+}
+
+// Parallel efficiency of GRAIN_WORK iterations cut into tasks of `grain`,
+// against the same pieces run one after the other
+static double bench_grain(int threads, long grain) {
+    double best = 1e30, seq_time = 1e30;
+    long ntasks = GRAIN_WORK / grain;
+
+    for (int r = 0; r < REPS; r++) {
+        double total = 0.0, t0 = omp_get_wtime();
+        for (long i = 0; i < ntasks; i++) total += work(grain);
+        double t = omp_get_wtime() - t0;
+        sink += total;
+        if (t < seq_time) seq_time = t;
+    }
+
+    for (int r = 0; r < REPS; r++) {
+        double t0 = 0.0, t1 = 0.0, total = 0.0;
+        #pragma omp parallel num_threads(threads)
+        #pragma omp single
+        {
+            t0 = omp_get_wtime();
+            for (long i = 0; i < ntasks; i++) {
+                #pragma omp task
+                {
+                    double v = work(grain);
+                    #pragma omp atomic
+                    total += v;
+                }
+            }
+            #pragma omp taskwait
+            t1 = omp_get_wtime();
+        }
+        sink += total;
+        if (t1 - t0 < best) best = t1 - t0;
+    }
+    return seq_time / (best * threads);
+}
+
+int main(int argc, char **argv) {
+    const char *path = argc > 1 ? argv[1] : "task_bench.csv";
+    int max_threads = argc > 2 ? atoi(argv[2]) : omp_get_max_threads();
+    if (max_threads < 1) max_threads = 1;
+
+    csv = fopen(path, "w");
+    if (!csv) {
+        perror(path);
+        return 1;
+    }
+    runtime = detect_runtime();
+    fprintf(csv, "runtime,threads,benchmark,param,value,unit\n");
+
+    printf("OpenMP runtime: %s (_OPENMP %d), writing %s\n\n", runtime, _OPENMP, path);
+    printf("%-8s %3s  %-14s %9s %12s\n", "runtime", "thr", "benchmark", "param", "value");
+
+    // Cost of one loop iteration, to turn min_grain into time
+    double iter_ns = 1e30;
+    for (int r = 0; r < REPS; r++) {
+        double t0 = omp_get_wtime();
+        sink += work(GRAIN_WORK);
+        double t = (omp_get_wtime() - t0) / GRAIN_WORK * 1e9;
+        if (t < iter_ns) iter_ns = t;
+    }
+
+    // 1, 2, 4, ... and finally max_threads itself if it is not a power of two
+    for (int threads = 1;; threads *= 2) {
+        if (threads > max_threads) threads = max_threads;
+
+        double spawn_run;
+        double spawn = bench_spawn(threads, &spawn_run);
+        emit(threads, "spawn", 0, spawn, "ns");
+        emit(threads, "spawn_run", 0, spawn_run, "ns");
+        emit(threads, "taskwait", 0, bench_round_trip(threads, 0), "ns");
+        emit(threads, "taskwait_none", 0, bench_round_trip(threads, 1), "ns");
+        emit(threads, "taskgroup", 0, bench_round_trip(threads, 2), "ns");
+        emit(threads, "depend_chain", 0, bench_depend(threads, 1), "ns");
+        emit(threads, "depend_indep", 0, bench_depend(threads, 0), "ns");
+
+        long min_grain = 0;
+        for (long grain = 16; grain <= GRAIN_WORK / threads; grain *= 4) {
+            double eff = bench_grain(threads, grain);
+            emit(threads, "grain_eff", grain, eff, "ratio");
+            if (eff >= MIN_EFFICIENCY) {
+                min_grain = grain;
+                break;
+            }
+        }
+        emit(threads, "min_grain", min_grain, min_grain * iter_ns, "ns");
+
+        if (threads == max_threads) break;
+    }
+
+    fclose(csv);
+    return 0;
+}
@@ -0,0 +1,178 @@
+// Generic parallel numerical integration (see integrate.h)
+
+#include "integrate.h"
+
+#include <omp.h>
+
+#define CACHE_LINE_SIZE 64
+#define PAD (CACHE_LINE_SIZE / sizeof(double))
+#define MAX_THREADS 256
+
+// Panels per task for STRATEGY_TASKS
+#define TASK_GRAIN (1L << 16)
+
+integ_options integ_default_options(void) {
+    integ_options opt = {RULE_SIMPSON, STRATEGY_REDUCTION, 1000000, 3, 0};
+    return opt;
+}
+
+const char *integ_rule_name(integ_rule rule) {
+    switch (rule) {
+    case RULE_MIDPOINT: return "midpoint";
+    case RULE_TRAPEZOID: return "trapezoid";
+    case RULE_SIMPSON: return "simpson";
+    case RULE_GAUSS_LEGENDRE: return "gauss";
+    }
+    return "?";
+}
+
+const char *integ_strategy_name(integ_strategy strategy) {
+    switch (strategy) {
+    case STRATEGY_SERIAL: return "serial";
+    case STRATEGY_REDUCTION: return "reduction";
+    case STRATEGY_PADDED: return "padded";
+    case STRATEGY_TASKS: return "tasks";
+    }
+    return "?";
+}
+
+// Gauss-Legendre nodes and weights on [-1, 1], 1 to 5 points
+static const double gl_nodes[5][5] = {
+    {0.0},
+    {-0.5773502691896257, 0.5773502691896257},
+    {-0.7745966692414834, 0.0, 0.7745966692414834},
+    {-0.8611363115940526, -0.3399810435848563, 0.3399810435848563, 0.8611363115940526},
+    {-0.9061798459386640, -0.5384693101056831, 0.0, 0.5384693101056831, 0.9061798459386640},
+};
+static const double gl_weights[5][5] = {
+    {2.0},
+    {1.0, 1.0},
+    {0.5555555555555556, 0.8888888888888888, 0.5555555555555556},
+    {0.3478548451374538, 0.6521451548625461, 0.6521451548625461, 0.3478548451374538},
+    {0.2369268850561891, 0.4786286704993665, 0.5688888888888889, 0.4786286704993665, 0.2369268850561891},
+};
+
+static integ_rule_def make_rule(const integ_options *opt) {
+    integ_rule_def r = {0};
+
+    switch (opt->rule) {
+    case RULE_MIDPOINT:
+        r.nodes = 1;
+        r.node[0] = 0.5;
+        r.weight[0] = 1.0;
+        break;
+    case RULE_TRAPEZOID:
+        // h * [f(x_0) + ... + f(x_{n-1})] + h/2 * (f(b) - f(a))
+        r.nodes = 1;
+        r.node[0] = 0.0;
+        r.weight[0] = 1.0;
+        r.end_weight = 0.5;
+        break;
+    case RULE_SIMPSON:
+        // h/6 * sum of [f(x_i) + 4 f(mid_i) + f(x_{i+1})], left ends shared
+        r.nodes = 2;
+        r.node[0] = 0.0;
+        r.weight[0] = 1.0 / 3.0;
+        r.node[1] = 0.5;
+        r.weight[1] = 2.0 / 3.0;
+        r.end_weight = 1.0 / 6.0;
+        break;
+    case RULE_GAUSS_LEGENDRE: {
+        int p = opt->gauss_points < 1 ? 1 : (opt->gauss_points > 5 ? 5 : opt->gauss_points);
+        r.nodes = p;
+        for (int k = 0; k < p; k++) {
+            r.node[k] = 0.5 * (gl_nodes[p - 1][k] + 1.0);
+            r.weight[k] = 0.5 * gl_weights[p - 1][k];
+        }
+        break;
+    }
+    }
+    return r;
+}
+
+long integ_evaluations(const integ_options *opt) {
+    integ_rule_def r = make_rule(opt);
+    return opt->panels * r.nodes + (r.end_weight != 0.0 ? 2 : 0);
+}
+
+// Panel loop for function-pointer integrands: one indirect call per node
+static double generic_range(const integ_kernel *k, void *ctx, const integ_rule_def *rule,
+                            double a, double h, long first, long last) {
+    double sum = 0.0;
+    for (int n = 0; n < rule->nodes; n++) {
+        double t = rule->node[n], part = 0.0;
+        for (long i = first; i < last; i++)
+            part += k->eval(a + ((double)i + t) * h, ctx);
+        sum += rule->weight[n] * part;
+    }
+    return sum;
+}
+
+static int team_size(const integ_options *opt) {
+    int n = opt->num_threads > 0 ? opt->num_threads : omp_get_max_threads();
+    return n > MAX_THREADS ? MAX_THREADS : n;
+}
+
+double integrate_kernel(const integ_kernel *k, void *ctx, double a, double b, const integ_options *opt) {
+    const integ_rule_def rule = make_rule(opt);
+    const long n = opt->panels > 0 ? opt->panels : 1;
+    const double h = (b - a) / (double)n;
+    const int threads = team_size(opt);
+    double sum = 0.0;
+
+    switch (opt->strategy) {
+    case STRATEGY_SERIAL:
+        sum = k->range(k, ctx, &rule, a, h, 0, n);
+        break;
+
+    case STRATEGY_REDUCTION:
+#pragma omp parallel num_threads(threads) reduction(+ : sum)
+        {
+            int ID = omp_get_thread_num();
+            int nthreads = omp_get_num_threads();
+            long chunk = n / nthreads;
+            long start = ID * chunk;
+            long end = (ID == nthreads - 1) ? n : (ID + 1) * chunk;
+            sum += k->range(k, ctx, &rule, a, h, start, end);
+        }
+        break;
+
+    case STRATEGY_PADDED: {
+        double partial[MAX_THREADS * PAD];
+        int used = 1;
+
+#pragma omp parallel num_threads(threads)
+        {
+            int ID = omp_get_thread_num();
+            int nthreads = omp_get_num_threads();
+            long chunk = n / nthreads;
+            long start = ID * chunk;
+            long end = (ID == nthreads - 1) ? n : (ID + 1) * chunk;
+            partial[ID * PAD] = k->range(k, ctx, &rule, a, h, start, end);
+            if (ID == 0) used = nthreads;
+        }
+
+        for (int i = 0; i < used; i++) sum += partial[i * PAD];
+        break;
+    }
+
+    case STRATEGY_TASKS:
+#pragma omp parallel num_threads(threads)
+#pragma omp single
+#pragma omp taskloop reduction(+ : sum) grainsize(1)
+        for (long start = 0; start < n; start += TASK_GRAIN) {
+            long end = start + TASK_GRAIN < n ? start + TASK_GRAIN : n;
+            sum += k->range(k, ctx, &rule, a, h, start, end);
+        }
+        break;
+    }
+
+    if (rule.end_weight != 0.0) sum += rule.end_weight * (k->eval(b, ctx) - k->eval(a, ctx));
+
+    return h * sum;
+}
+
+double integrate(integrand_fn f, void *ctx, double a, double b, const integ_options *opt) {
+    const integ_kernel k = {"function", f, generic_range};
+    return integrate_kernel(&k, ctx, a, b, opt);
+}
@@ -0,0 +1,101 @@
+// Generic parallel numerical integration
+//
+// Integrates any f(x) over [a, b] with a composite quadrature rule and a
+// choice of OpenMP strategy. Integrands can be given two ways:
+//
+//   1. a function pointer, for anything (closures go through ctx):
+//        double gauss(double x, void *ctx) { ... }
+//        integrate(gauss, &sigma, 0.0, 1.0, &opt);
+//
+//   2. an expression, turned into a kernel with the integrand inlined into the
+//      panel loop so the compiler can vectorize it:
+//        INTEG_KERNEL(pi_kernel, x, 4.0 / (1.0 + x * x))
+//        integrate_kernel(&pi_kernel, NULL, 0.0, 1.0, &opt);
+
+#ifndef INTEGRATE_H
+#define INTEGRATE_H
+
+typedef double (*integrand_fn)(double x, void *ctx);
+
+typedef enum {
+    RULE_MIDPOINT,
+    RULE_TRAPEZOID,
+    RULE_SIMPSON,
+    RULE_GAUSS_LEGENDRE,
+} integ_rule;
+
+typedef enum {
+    STRATEGY_SERIAL,    // one thread
+    STRATEGY_REDUCTION, // contiguous block per thread, reduction(+)
+    STRATEGY_PADDED,    // contiguous block per thread, cache-line padded partial sums
+    STRATEGY_TASKS,     // taskloop with a task reduction
+} integ_strategy;
+
+typedef struct {
+    integ_rule rule;
+    integ_strategy strategy;
+    long panels;      // number of subintervals of [a, b]
+    int gauss_points; // points per panel for RULE_GAUSS_LEGENDRE (1..5)
+    int num_threads;  // 0 = OpenMP default
+} integ_options;
+
+// Quadrature rule on one panel [0, 1]: sum of weight[k] * f(node[k]). Rules
+// that share panel endpoints (trapezoid, Simpson) evaluate only the left end
+// and fix up the two ends of [a, b] with end_weight * (f(b) - f(a)).
+#define INTEG_MAX_NODES 5
+
+typedef struct {
+    int nodes;
+    double node[INTEG_MAX_NODES];
+    double weight[INTEG_MAX_NODES];
+    double end_weight;
+} integ_rule_def;
+
+typedef struct integ_kernel integ_kernel;
+
+// Sum over panels first..last-1 of sum_k weight[k] * f(a + (i + node[k]) * h)
+typedef double (*integ_range_fn)(const integ_kernel *k, void *ctx, const integ_rule_def *rule,
+                                 double a, double h, long first, long last);
+
+struct integ_kernel {
+    const char *name;
+    integrand_fn eval;
+    integ_range_fn range;
+};
+
+// Default options: Simpson, reduction strategy, 10^6 panels, 3-point Gauss
+integ_options integ_default_options(void);
+
+const char *integ_rule_name(integ_rule rule);
+const char *integ_strategy_name(integ_strategy strategy);
+
+// Number of integrand evaluations the options imply
+long integ_evaluations(const integ_options *opt);
+
+double integrate(integrand_fn f, void *ctx, double a, double b, const integ_options *opt);
+double integrate_kernel(const integ_kernel *k, void *ctx, double a, double b, const integ_options *opt);
+
+// Builds `static const integ_kernel name` whose panel loop has `expr` (a
+// function of the variable named `x`) inlined and is marked omp simd
+#define INTEG_KERNEL(name, x, expr)                                                          \
+    static inline double name##_eval_inline(double x) { return (expr); }                     \
+    static double name##_eval(double x, void *ctx) {                                         \
+        (void)ctx;                                                                           \
+        return name##_eval_inline(x);                                                        \
+    }                                                                                        \
+    static double name##_range(const integ_kernel *k, void *ctx, const integ_rule_def *rule, \
+                               double a, double h, long first, long last) {                  \
+        (void)k;                                                                             \
+        (void)ctx;                                                                           \
+        double sum = 0.0;                                                                    \
+        for (int n = 0; n < rule->nodes; n++) {                                              \
+            double t = rule->node[n], w = rule->weight[n], part = 0.0;                       \
+            _Pragma("omp simd reduction(+ : part)") for (long i = first; i < last; i++)      \
+                part += name##_eval_inline(a + ((double)i + t) * h);                         \
+            sum += w * part;                                                                 \
+        }                                                                                    \
+        return sum;                                                                          \
+    }                                                                                        \
+    static const integ_kernel name = {#name, name##_eval, name##_range}
+
+#endif
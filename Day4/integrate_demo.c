@@ -0,0 +1,142 @@
+// Generic Integration Library Demo
+// Integrates several functions with every rule (Gauss-Legendre with each point
+// count) and strategy in integrate.c, comparing a function-pointer integrand
+// against an inlined INTEG_KERNEL one. Every result is checked against the
+// exact value; the exit status is the number of failures.
+// Compile: gcc -fopenmp -O2 integrate_demo.c integrate.c -o integrate_demo -lm
+// Run: OMP_NUM_THREADS=8 ./integrate_demo [panels]
+
+#include <float.h>
+#include <math.h>
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "integrate.h"
+
+// The integrand every pi program in this repo hard-codes, as a kernel...
+INTEG_KERNEL(pi_kernel, x, 4.0 / (1.0 + x * x));
+INTEG_KERNEL(sin_kernel, x, sin(x));
+INTEG_KERNEL(circle_kernel, x, sqrt(1.0 - x * x));
+
+// ...and as a plain function
+static double pi_integrand(double x, void *ctx) {
+    (void)ctx;
+    return 4.0 / (1.0 + x * x);
+}
+
+// Integrands with parameters go through ctx
+static double gaussian(double x, void *ctx) {
+    double sigma = *(const double *)ctx;
+    return exp(-x * x / (2.0 * sigma * sigma));
+}
+
+typedef struct {
+    const char *label;
+    const integ_kernel *kernel; // NULL: use fn
+    integrand_fn fn;
+    void *ctx;
+    double a, b;
+    double exact;
+    double smoothness; // error order the integrand allows, whatever the rule
+} test_case;
+
+static double run(const test_case *t, const integ_options *opt, double *seconds) {
+    double start = omp_get_wtime();
+    double value = t->kernel ? integrate_kernel(t->kernel, t->ctx, t->a, t->b, opt)
+                             : integrate(t->fn, t->ctx, t->a, t->b, opt);
+    *seconds = omp_get_wtime() - start;
+    return value;
+}
+
+// Order of the composite rule's error in the panel width
+static double rule_order(const integ_options *opt) {
+    switch (opt->rule) {
+    case RULE_SIMPSON: return 4.0;
+    case RULE_GAUSS_LEGENDRE: return 2.0 * opt->gauss_points;
+    default: return 2.0;
+    }
+}
+
+// Truncation error bound with a generous constant, plus rounding in the sum
+// over panels
+static double tolerance(const test_case *t, const integ_options *opt) {
+    double h = (t->b - t->a) / opt->panels;
+    double order = fmin(rule_order(opt), t->smoothness);
+    return 10.0 * (t->b - t->a) * pow(h, order) + 64.0 * DBL_EPSILON * sqrt((double)opt->panels) * fabs(t->exact);
+}
+
+// Print one result; returns 1 if it is off by more than the tolerance
+static int check_row(const test_case *t, const integ_options *opt, double value, double seconds) {
+    char rule[16];
+    if (opt->rule == RULE_GAUSS_LEGENDRE)
+        snprintf(rule, sizeof(rule), "%s-%d", integ_rule_name(opt->rule), opt->gauss_points);
+    else
+        snprintf(rule, sizeof(rule), "%s", integ_rule_name(opt->rule));
+
+    double error = fabs(value - t->exact);
+    int failed = !(error <= tolerance(t, opt));
+    printf("%-22s %-10s %-10s %20.15f %10.2e %9.4f %10.1f%s\n", t->label, rule,
+           integ_strategy_name(opt->strategy), value, error, seconds,
+           integ_evaluations(opt) / seconds * 1e-6, failed ? "  FAIL" : "");
+    return failed;
+}
+
+int main(int argc, char **argv) {
+    long panels = argc > 1 ? atol(argv[1]) : 10000000;
+    double sigma = 0.5;
+
+    const test_case cases[] = {
+        {"4/(1+x^2) kernel", &pi_kernel, NULL, NULL, 0.0, 1.0, M_PI, INFINITY},
+        {"4/(1+x^2) function", NULL, pi_integrand, NULL, 0.0, 1.0, M_PI, INFINITY},
+        {"sin(x) on [0,pi]", &sin_kernel, NULL, NULL, 0.0, M_PI, 2.0, INFINITY},
+        // Square-root singularity at x = 1: every rule converges as h^1.5
+        {"sqrt(1-x^2)", &circle_kernel, NULL, NULL, 0.0, 1.0, M_PI / 4.0, 1.5},
+        {"gaussian sigma=0.5", NULL, gaussian, &sigma, 0.0, 1.0,
+         sigma * sqrt(M_PI / 2.0) * erf(1.0 / (sigma * sqrt(2.0))), INFINITY},
+    };
+    const int num_cases = sizeof(cases) / sizeof(cases[0]);
+    const integ_rule rules[] = {RULE_MIDPOINT, RULE_TRAPEZOID, RULE_SIMPSON, RULE_GAUSS_LEGENDRE};
+    int failures = 0;
+    const integ_strategy strategies[] = {STRATEGY_SERIAL, STRATEGY_REDUCTION, STRATEGY_PADDED, STRATEGY_TASKS};
+
+    printf("Generic integration: %ld panels, %d threads\n\n", panels, omp_get_max_threads());
+    printf("%-22s %-10s %-10s %20s %10s %9s %10s\n",
+           "Integrand", "Rule", "Strategy", "Value", "Error", "Time (s)", "Mevals/s");
+
+    // Every rule on every integrand, Gauss-Legendre with every point count,
+    // parallel reduction
+    for (int c = 0; c < num_cases; c++) {
+        for (int r = 0; r < 4; r++) {
+            int last_points = rules[r] == RULE_GAUSS_LEGENDRE ? INTEG_MAX_NODES : 1;
+            for (int points = 1; points <= last_points; points++) {
+                integ_options opt = integ_default_options();
+                opt.rule = rules[r];
+                opt.panels = panels;
+                if (rules[r] == RULE_GAUSS_LEGENDRE) opt.gauss_points = points;
+
+                double seconds;
+                double value = run(&cases[c], &opt, &seconds);
+                failures += check_row(&cases[c], &opt, value, seconds);
+            }
+        }
+    }
+    printf("\n");
+
+    // Every strategy on pi, inlined kernel vs function pointer
+    for (int c = 0; c < 2; c++) {
+        for (int s = 0; s < 4; s++) {
+            integ_options opt = integ_default_options();
+            opt.rule = RULE_MIDPOINT;
+            opt.strategy = strategies[s];
+            opt.panels = panels;
+
+            double seconds;
+            double value = run(&cases[c], &opt, &seconds);
+            failures += check_row(&cases[c], &opt, value, seconds);
+        }
+    }
+
+    if (failures) printf("\n%d results outside tolerance\n", failures);
+    return failures;
+}
@@ -1,18 +1,29 @@
 // Integration Synchronization Methods Comparison
 // Uses proven functions from Day2 examples
 // Compile: clang -fopenmp -O2 integration_sync_comparison.c -o integration_sync_comparison -lm
-// Run: OMP_NUM_THREADS=8 ./integration_sync_comparison
+//          (add -march=native to let the SIMD method use the widest vectors)
+// Run: OMP_NUM_THREADS=8 ./integration_sync_comparison [method ...]
+//      methods: critical race nosync falsefix reduction atomic simd (default: all)
 
 #include <omp.h>
 #include <stdio.h>
 #include <time.h>
 #include <math.h>
+#include <string.h>
 
 #define NUM_THREADS 8
 #define NUM_STEPS 100000000
 #define CACHE_LINE_SIZE 64
 #define PAD (CACHE_LINE_SIZE / sizeof(double))
 
+// SIMD kernel shape: SIMD_ACCS independent vectors of SIMD_WIDTH doubles each
+#define SIMD_WIDTH 4
+#define SIMD_ACCS 4
+#define SIMD_STEPS (SIMD_WIDTH * SIMD_ACCS) // steps per unrolled iteration
+#define SIMD_REANCHOR 4096                  // steps between exact recomputations of x
+
+typedef double vdouble __attribute__((vector_size(SIMD_WIDTH * sizeof(double))));
+
 // Global variables for different methods
 static double step;
 static double sum_arr[NUM_THREADS * PAD] = {0};
@@ -168,6 +179,70 @@ double pi_atomic() {
     return step * total_sum;
 }
 
+// Method 7: SIMD kernel with several independent vector accumulators
+//
+// The scalar loops above have one accumulator, so every add waits for the
+// previous one, and each step pays a full divide latency. Here each iteration
+// covers SIMD_STEPS midpoints spread over SIMD_ACCS vector accumulators, which
+// keeps several divides in flight. x is advanced by adding a constant stride
+// instead of (i + 0.5) * step, and recomputed exactly every SIMD_REANCHOR steps
+// so rounding error can't build up over a long range.
+static double pi_simd_range(long start, long end) {
+    vdouble acc[SIMD_ACCS];
+    vdouble x[SIMD_ACCS];
+    vdouble lane;
+    const vdouble zero = {0};
+    const vdouble ones = zero + 1.0, fours = zero + 4.0;
+    const double stride = SIMD_STEPS * step;
+
+    for (int l = 0; l < SIMD_WIDTH; l++) lane[l] = l + 0.5;
+    for (int a = 0; a < SIMD_ACCS; a++) acc[a] = zero;
+
+    long i = start;
+    while (end - i >= SIMD_STEPS) {
+        long block_end = i + SIMD_REANCHOR < end ? i + SIMD_REANCHOR : end;
+
+        for (int a = 0; a < SIMD_ACCS; a++)
+            x[a] = ((double)(i + a * SIMD_WIDTH) + lane) * step;
+
+        for (; block_end - i >= SIMD_STEPS; i += SIMD_STEPS) {
+            for (int a = 0; a < SIMD_ACCS; a++) {
+                acc[a] += fours / (ones + x[a] * x[a]);
+                x[a] += stride;
+            }
+        }
+    }
+
+    double sum = 0.0;
+    for (int a = 0; a < SIMD_ACCS; a++)
+        for (int l = 0; l < SIMD_WIDTH; l++)
+            sum += acc[a][l];
+
+    // Scalar tail, fewer than SIMD_STEPS steps
+    for (; i < end; i++) {
+        double xi = (i + 0.5) * step;
+        sum += 4.0 / (1.0 + xi * xi);
+    }
+    return sum;
+}
+
+double pi_simd() {
+    double total_sum = 0.0;
+
+    #pragma omp parallel num_threads(NUM_THREADS) reduction(+:total_sum)
+    {
+        int ID = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        long chunk = NUM_STEPS / nthreads;
+        long start = ID * chunk;
+        long end = (ID == nthreads - 1) ? NUM_STEPS : (ID + 1) * chunk;
+
+        total_sum += pi_simd_range(start, end);
+    }
+
+    return step * total_sum;
+}
+
 // Reference calculation (sequential)
 double pi_reference() {
     double total_sum = 0.0;
@@ -180,13 +255,62 @@ double pi_reference() {
     return step * total_sum;
 }
 
-int main() {
+typedef struct {
+    const char *key;     // name on the command line
+    const char *title;   // test heading
+    const char *label;   // row label in the summary tables
+    double (*compute)(void);
+    double pi;
+    double time;
+    int ran;
+} method_t;
+
+static method_t methods[] = {
+    {"critical", "🔒 Test 1: Critical Section (from int_critical.c)", "Critical:", pi_critical_section},
+    {"race", "💥 Test 2: Race Condition (BAITED!)", "Race:", pi_no_sync_race},
+    {"nosync", "✅ Test 3: Proper No Sync (from int_nosync.c)", "No Sync:", pi_no_sync_proper},
+    {"falsefix", "🚀 Test 4: False Sharing Fix (from int_falsefix.c)", "False Fix:", pi_false_sharing_fix},
+    {"reduction", "🎯 Test 5: Reduction (from int_sync.c)", "Reduction:", pi_reduction},
+    {"atomic", "⚛️  Test 6: Atomic Operations", "Atomic:", pi_atomic},
+    {"simd", "⚡ Test 7: SIMD Multi-Accumulator Kernel", "SIMD:", pi_simd},
+};
+
+#define NUM_METHODS ((int)(sizeof(methods) / sizeof(methods[0])))
+
+// With no arguments every method runs, otherwise only the ones named
+static int method_selected(const method_t *m, int argc, char **argv) {
+    if (argc < 2) return 1;
+    for (int i = 1; i < argc; i++)
+        if (strcmp(argv[i], m->key) == 0) return 1;
+    return 0;
+}
+
+static void print_underline(const char *title) {
+    // Headings start with an emoji (4 bytes in UTF-8) that displays 2 columns wide
+    size_t width = strlen(title) - 2;
+    for (size_t i = 0; i < width; i++) putchar('-');
+    putchar('\n');
+}
+
+int main(int argc, char **argv) {
     printf("🎬 Integration Synchronization Methods Comparison\n");
     printf("================================================\n\n");
     
     printf("Computing π using numerical integration: ∫₀¹ 4/(1+x²) dx\n");
     printf("Steps: %d, Threads: %d\n", NUM_STEPS, NUM_THREADS);
     printf("Expected result: π ≈ 3.141592653589793...\n\n");
+
+    for (int i = 1; i < argc; i++) {
+        int known = 0;
+        for (int m = 0; m < NUM_METHODS; m++)
+            if (strcmp(argv[i], methods[m].key) == 0) known = 1;
+        if (!known) {
+            printf("Unknown method '%s', choose from:", argv[i]);
+            for (int m = 0; m < NUM_METHODS; m++) printf(" %s", methods[m].key);
+            printf("\n");
+            return 1;
+        }
+    }
     
     // Initialize step size
     step = 1.0 / (double)NUM_STEPS;
@@ -197,110 +321,59 @@ int main() {
     double reference_pi = pi_reference();
     double ref_time = omp_get_wtime() - start_ref;
     printf("Reference π: %.15f (computed in %.3f seconds)\n\n", reference_pi, ref_time);
-    
-    // Test 1: Critical Section
-    printf("🔒 Test 1: Critical Section (from int_critical.c)\n");
-    printf("------------------------------------------------\n");
-    double start = omp_get_wtime();
-    double pi_critical = pi_critical_section();
-    double critical_time = omp_get_wtime() - start;
-    printf("Critical time: %.3f seconds, π: %.15f\n", critical_time, pi_critical);
-    printf("Error: %.2e (%.4f%%)\n\n", 
-           fabs(pi_critical - reference_pi), 
-           fabs(pi_critical - reference_pi) / reference_pi * 100);
-    
-    // Test 2: Race Condition (BAITED!)
-    printf("💥 Test 2: Race Condition (BAITED!)\n");
-    printf("----------------------------------\n");
-    start = omp_get_wtime();
-    double pi_race = pi_no_sync_race();
-    double race_time = omp_get_wtime() - start;
-    printf("Race time: %.3f seconds, π: %.15f\n", race_time, pi_race);
-    printf("Error: %.2e (%.4f%%)\n", 
-           fabs(pi_race - reference_pi), 
-           fabs(pi_race - reference_pi) / reference_pi * 100);
-    printf("Race condition detected: %s\n\n", 
-           fabs(pi_race - reference_pi) > 1e-10 ? "YES!" : "NO");
-    
-    // Test 3: Proper No Sync
-    printf("✅ Test 3: Proper No Sync (from int_nosync.c)\n");
-    printf("--------------------------------------------\n");
-    start = omp_get_wtime();
-    double pi_no_sync = pi_no_sync_proper();
-    double no_sync_time = omp_get_wtime() - start;
-    printf("No sync time: %.3f seconds, π: %.15f\n", no_sync_time, pi_no_sync);
-    printf("Error: %.2e (%.4f%%)\n\n", 
-           fabs(pi_no_sync - reference_pi), 
-           fabs(pi_no_sync - reference_pi) / reference_pi * 100);
-    
-    // Test 4: False Sharing Fix
-    printf("🚀 Test 4: False Sharing Fix (from int_falsefix.c)\n");
-    printf("------------------------------------------------\n");
-    start = omp_get_wtime();
-    double pi_false_fix = pi_false_sharing_fix();
-    double false_fix_time = omp_get_wtime() - start;
-    printf("False fix time: %.3f seconds, π: %.15f\n", false_fix_time, pi_false_fix);
-    printf("Error: %.2e (%.4f%%)\n\n", 
-           fabs(pi_false_fix - reference_pi), 
-           fabs(pi_false_fix - reference_pi) / reference_pi * 100);
-    
-    // Test 5: Reduction
-    printf("🎯 Test 5: Reduction (from int_sync.c)\n");
-    printf("-------------------------------------\n");
-    start = omp_get_wtime();
-    double pi_reduction_result = pi_reduction();
-    double reduction_time = omp_get_wtime() - start;
-    printf("Reduction time: %.3f seconds, π: %.15f\n", reduction_time, pi_reduction_result);
-    printf("Error: %.2e (%.4f%%)\n\n", 
-           fabs(pi_reduction_result - reference_pi), 
-           fabs(pi_reduction_result - reference_pi) / reference_pi * 100);
-    
-    // Test 6: Atomic Operations
-    printf("⚛️  Test 6: Atomic Operations\n");
-    printf("----------------------------\n");
-    start = omp_get_wtime();
-    double pi_atomic_result = pi_atomic();
-    double atomic_time = omp_get_wtime() - start;
-    printf("Atomic time: %.3f seconds, π: %.15f\n", atomic_time, pi_atomic_result);
-    printf("Error: %.2e (%.4f%%)\n\n", 
-           fabs(pi_atomic_result - reference_pi), 
-           fabs(pi_atomic_result - reference_pi) / reference_pi * 100);
+
+    for (int i = 0; i < NUM_METHODS; i++) {
+        method_t *m = &methods[i];
+        if (!method_selected(m, argc, argv)) continue;
+
+        printf("%s\n", m->title);
+        print_underline(m->title);
+        double start = omp_get_wtime();
+        m->pi = m->compute();
+        m->time = omp_get_wtime() - start;
+        m->ran = 1;
+
+        printf("%.*s time: %.3f seconds, π: %.15f\n", (int)strlen(m->label) - 1, m->label, m->time, m->pi);
+        printf("Error: %.2e (%.4f%%)\n", 
+               fabs(m->pi - reference_pi), 
+               fabs(m->pi - reference_pi) / reference_pi * 100);
+        if (m->compute == pi_no_sync_race) {
+            printf("Race condition detected: %s\n", 
+                   fabs(m->pi - reference_pi) > 1e-10 ? "YES!" : "NO");
+        }
+        printf("\n");
+    }
     
     // Performance comparison
     printf("📊 Performance Comparison\n");
     printf("========================\n");
-    printf("Reference:    %.3f seconds (sequential)\n", ref_time);
-    printf("Critical:     %.3f seconds (%.1fx %s)\n", critical_time, 
-           ref_time/critical_time, critical_time < ref_time ? "faster" : "slower");
-    printf("Race:         %.3f seconds (%.1fx %s) %s\n", race_time, 
-           ref_time/race_time, race_time < ref_time ? "faster" : "slower",
-           fabs(pi_race - reference_pi) > 1e-10 ? "💥 WRONG!" : "");
-    printf("No Sync:      %.3f seconds (%.1fx %s)\n", no_sync_time, 
-           ref_time/no_sync_time, no_sync_time < ref_time ? "faster" : "slower");
-    printf("False Fix:    %.3f seconds (%.1fx %s)\n", false_fix_time, 
-           ref_time/false_fix_time, false_fix_time < ref_time ? "faster" : "slower");
-    printf("Reduction:    %.3f seconds (%.1fx %s)\n", reduction_time, 
-           ref_time/reduction_time, reduction_time < ref_time ? "faster" : "slower");
-    printf("Atomic:       %.3f seconds (%.1fx %s)\n", atomic_time, 
-           ref_time/atomic_time, atomic_time < ref_time ? "faster" : "slower");
+    printf("Reference:    %.3f seconds (sequential, %.2f Gsteps/s)\n", ref_time,
+           NUM_STEPS / ref_time * 1e-9);
+    for (int i = 0; i < NUM_METHODS; i++) {
+        method_t *m = &methods[i];
+        if (!m->ran) continue;
+        int wrong = m->compute == pi_no_sync_race && fabs(m->pi - reference_pi) > 1e-10;
+        printf("%-13s %.3f seconds (%.1fx %s, %.2f Gsteps/s)%s\n", m->label, m->time,
+               ref_time / m->time, m->time < ref_time ? "faster" : "slower",
+               NUM_STEPS / m->time * 1e-9, wrong ? " 💥 WRONG!" : "");
+    }
     
     // Accuracy comparison
     printf("\n🎯 Accuracy Comparison\n");
     printf("=====================\n");
     printf("Reference:    %.15f (100.0000%% accurate)\n", reference_pi);
-    printf("Critical:     %.15f (%.4f%% error)\n", pi_critical, 
-           fabs(pi_critical - reference_pi) / reference_pi * 100);
-    printf("Race:         %.15f (%.4f%% error) %s\n", pi_race, 
-           fabs(pi_race - reference_pi) / reference_pi * 100,
-           fabs(pi_race - reference_pi) > 1e-10 ? "💥 RACE CONDITION!" : "✅");
-    printf("No Sync:      %.15f (%.4f%% error)\n", pi_no_sync, 
-           fabs(pi_no_sync - reference_pi) / reference_pi * 100);
-    printf("False Fix:    %.15f (%.4f%% error)\n", pi_false_fix, 
-           fabs(pi_false_fix - reference_pi) / reference_pi * 100);
-    printf("Reduction:    %.15f (%.4f%% error)\n", pi_reduction_result, 
-           fabs(pi_reduction_result - reference_pi) / reference_pi * 100);
-    printf("Atomic:       %.15f (%.4f%% error)\n", pi_atomic_result, 
-           fabs(pi_atomic_result - reference_pi) / reference_pi * 100);
+    for (int i = 0; i < NUM_METHODS; i++) {
+        method_t *m = &methods[i];
+        if (!m->ran) continue;
+        if (m->compute == pi_no_sync_race) {
+            printf("%-13s %.15f (%.4f%% error) %s\n", m->label, m->pi, 
+                   fabs(m->pi - reference_pi) / reference_pi * 100,
+                   fabs(m->pi - reference_pi) > 1e-10 ? "💥 RACE CONDITION!" : "✅");
+        } else {
+            printf("%-13s %.15f (%.4f%% error)\n", m->label, m->pi, 
+                   fabs(m->pi - reference_pi) / reference_pi * 100);
+        }
+    }
     
     printf("\n🎓 Key Lessons from Day2 Integration:\n");
     printf("- Critical sections work but have high overhead\n");
@@ -309,6 +382,7 @@ int main() {
     printf("- False sharing can hurt performance even without races\n");
     printf("- Reduction is the most elegant solution\n");
     printf("- Atomic operations are fast but limited\n");
+    printf("- Independent vector accumulators beat any synchronization choice\n");
     
     printf("\n✅ Integration synchronization comparison completed!\n");
     return 0;
@@ -0,0 +1,226 @@
+// Cache-blocked, register-tiled matrix multiplication
+//
+// Loop structure (outermost first), following the usual GotoBLAS/BLIS layout:
+//   jc: NC-wide column panels of B and C          (B panel sized for L3)
+//   pc: KC-deep slices of the k dimension         (packed B panel shared by all threads)
+//   ic: MC-tall row blocks of A and C             (packed A block sized for L2)
+//   jr: NR-wide strips of the packed B panel      (one strip sized for L1)
+//   ir: MR-tall strips of the packed A block      (micro-kernel on an MR x NR tile of C)
+//
+// MR and NR come from the micro-kernel picked at run time (gemm_kernels.c).
+//
+// A and B are copied ("packed") into contiguous buffers so the micro-kernel only
+// ever streams through unit-stride memory, no matter how large the leading
+// dimensions are.
+
+#include "gemm.h"
+
+#include <omp.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Cache blocking parameters, override with -DGEMM_MC=... etc.
+#ifndef GEMM_MC
+#define GEMM_MC 96 // rows of A per L2 block (multiple of every kernel's mr)
+#endif
+#ifndef GEMM_KC
+#define GEMM_KC 256 // depth of one packed slice
+#endif
+#ifndef GEMM_NC
+#define GEMM_NC 4096 // columns of B per L3 panel (multiple of every kernel's nr)
+#endif
+
+#define GEMM_ALIGN 64
+
+// Largest register tile any kernel in gemm_kernels.c uses
+#define GEMM_MAX_MR 8
+#define GEMM_MAX_NR 16
+
+static int min_int(int a, int b) { return a < b ? a : b; }
+static int round_up(int x, int m) { return (x + m - 1) / m * m; }
+
+static double *alloc_aligned(size_t count) {
+    void *p = NULL;
+    if (posix_memalign(&p, GEMM_ALIGN, count * sizeof(double)) != 0) return NULL;
+    return p;
+}
+
+// Pack an mr-tall strip of A (rows <= mr valid rows, kc columns) as kc groups
+// of mr consecutive values, zero-padding the missing rows
+static void pack_a_strip(int mr, int rows, int kc, const double *A, int lda, double *Ap) {
+    for (int p = 0; p < kc; p++) {
+        for (int i = 0; i < rows; i++) Ap[p * mr + i] = A[(size_t)i * lda + p];
+        for (int i = rows; i < mr; i++) Ap[p * mr + i] = 0.0;
+    }
+}
+
+// Pack an nr-wide strip of B (kc rows, cols <= nr valid columns) as kc groups
+// of nr consecutive values, zero-padding the missing columns
+static void pack_b_strip(int nr, int kc, int cols, const double *B, int ldb, double *Bp) {
+    for (int p = 0; p < kc; p++) {
+        const double *row = B + (size_t)p * ldb;
+        for (int j = 0; j < cols; j++) Bp[p * nr + j] = row[j];
+        for (int j = cols; j < nr; j++) Bp[p * nr + j] = 0.0;
+    }
+}
+
+// Partial tiles on the bottom/right edge go through a scratch tile so the
+// micro-kernels themselves never need bounds checks
+static void edge_kernel(const gemm_kernel *k, int rows, int cols, int kc,
+                        const double *Ap, const double *Bp, double *C, int ldc) {
+    double tile[GEMM_MAX_MR * GEMM_MAX_NR];
+    memset(tile, 0, sizeof(tile));
+    k->fn(kc, Ap, Bp, tile, k->nr);
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < cols; j++)
+            C[(size_t)i * ldc + j] += tile[i * k->nr + j];
+}
+
+void gemm_blocked(int M, int N, int K,
+                  const double *A, int lda,
+                  const double *B, int ldb,
+                  double *C, int ldc) {
+    gemm_blocked_kernel(gemm_kernel_best(), M, N, K, A, lda, B, ldb, C, ldc);
+}
+
+void gemm_blocked_kernel(const gemm_kernel *k, int M, int N, int K,
+                         const double *A, int lda,
+                         const double *B, int ldb,
+                         double *C, int ldc) {
+    if (M <= 0 || N <= 0 || K <= 0) return;
+
+    int kc_max = min_int(GEMM_KC, K);
+    int mr = k->mr, nr = k->nr;
+    int nc_max = round_up(min_int(GEMM_NC, N), nr);
+    int m_pad = round_up(M, mr);
+
+    // Both packed buffers are shared by the team: B is packed once per (jc, pc)
+    // and read by everybody, A is packed strip by strip in parallel
+    double *Ap = alloc_aligned((size_t)m_pad * kc_max);
+    double *Bp = alloc_aligned((size_t)nc_max * kc_max);
+    if (!Ap || !Bp) {
+        free(Ap);
+        free(Bp);
+        gemm_naive(M, N, K, A, lda, B, ldb, C, ldc);
+        return;
+    }
+
+#pragma omp parallel
+    for (int jc = 0; jc < N; jc += GEMM_NC) {
+        int nc = min_int(GEMM_NC, N - jc);
+
+        for (int pc = 0; pc < K; pc += GEMM_KC) {
+            int kc = min_int(GEMM_KC, K - pc);
+
+#pragma omp for schedule(static) nowait
+            for (int js = 0; js < nc; js += nr)
+                pack_b_strip(nr, kc, min_int(nr, nc - js),
+                             B + (size_t)pc * ldb + jc + js, ldb, Bp + (size_t)js * kc);
+
+#pragma omp for schedule(static)
+            for (int is = 0; is < M; is += mr)
+                pack_a_strip(mr, min_int(mr, M - is), kc,
+                             A + (size_t)is * lda + pc, lda, Ap + (size_t)is * kc);
+
+            // Consecutive iterations share the same ic, so each thread keeps
+            // reusing one packed A block from its L2 while walking B strips
+#pragma omp for collapse(2) schedule(static)
+            for (int ic = 0; ic < M; ic += GEMM_MC) {
+                for (int jr = 0; jr < nc; jr += nr) {
+                    int cols = min_int(nr, nc - jr);
+                    int ic_end = min_int(ic + GEMM_MC, M);
+                    const double *b = Bp + (size_t)jr * kc;
+
+                    for (int ir = ic; ir < ic_end; ir += mr) {
+                        int rows = min_int(mr, ic_end - ir);
+                        const double *a = Ap + (size_t)ir * kc;
+                        double *c = C + (size_t)ir * ldc + jc + jr;
+
+                        if (rows == mr && cols == nr)
+                            k->fn(kc, a, b, c, ldc);
+                        else
+                            edge_kernel(k, rows, cols, kc, a, b, c, ldc);
+                    }
+                }
+            }
+            // implicit barrier: nobody repacks while others still read Ap/Bp
+        }
+    }
+
+    free(Ap);
+    free(Bp);
+}
+
+void gemm_serial_kernel(const gemm_kernel *k, int M, int N, int K,
+                        const double *A, int lda,
+                        const double *B, int ldb,
+                        double *C, int ldc) {
+    if (M <= 0 || N <= 0 || K <= 0) return;
+
+    int kc_max = min_int(GEMM_KC, K);
+    int mr = k->mr, nr = k->nr;
+    int mc_max = round_up(min_int(GEMM_MC, M), mr);
+    int nc_max = round_up(min_int(GEMM_NC, N), nr);
+
+    // Private buffers, only one MC block of A is packed at a time
+    double *Ap = alloc_aligned((size_t)mc_max * kc_max);
+    double *Bp = alloc_aligned((size_t)nc_max * kc_max);
+    if (!Ap || !Bp) {
+        free(Ap);
+        free(Bp);
+        gemm_naive(M, N, K, A, lda, B, ldb, C, ldc);
+        return;
+    }
+
+    for (int jc = 0; jc < N; jc += GEMM_NC) {
+        int nc = min_int(GEMM_NC, N - jc);
+
+        for (int pc = 0; pc < K; pc += GEMM_KC) {
+            int kc = min_int(GEMM_KC, K - pc);
+
+            for (int js = 0; js < nc; js += nr)
+                pack_b_strip(nr, kc, min_int(nr, nc - js),
+                             B + (size_t)pc * ldb + jc + js, ldb, Bp + (size_t)js * kc);
+
+            for (int ic = 0; ic < M; ic += GEMM_MC) {
+                int mc = min_int(GEMM_MC, M - ic);
+
+                for (int is = 0; is < mc; is += mr)
+                    pack_a_strip(mr, min_int(mr, mc - is), kc,
+                                 A + (size_t)(ic + is) * lda + pc, lda, Ap + (size_t)is * kc);
+
+                for (int jr = 0; jr < nc; jr += nr) {
+                    int cols = min_int(nr, nc - jr);
+                    const double *b = Bp + (size_t)jr * kc;
+
+                    for (int ir = 0; ir < mc; ir += mr) {
+                        int rows = min_int(mr, mc - ir);
+                        const double *a = Ap + (size_t)ir * kc;
+                        double *c = C + (size_t)(ic + ir) * ldc + jc + jr;
+
+                        if (rows == mr && cols == nr)
+                            k->fn(kc, a, b, c, ldc);
+                        else
+                            edge_kernel(k, rows, cols, kc, a, b, c, ldc);
+                    }
+                }
+            }
+        }
+    }
+
+    free(Ap);
+    free(Bp);
+}
+
+void gemm_naive(int M, int N, int K,
+                const double *A, int lda,
+                const double *B, int ldb,
+                double *C, int ldc) {
+    for (int i = 0; i < M; i++)
+        for (int j = 0; j < N; j++) {
+            double sum = 0.0;
+            for (int k = 0; k < K; k++)
+                sum += A[(size_t)i * lda + k] * B[(size_t)k * ldb + j];
+            C[(size_t)i * ldc + j] += sum;
+        }
+}
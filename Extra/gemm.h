@@ -0,0 +1,64 @@
+// Cache-blocked, register-tiled matrix multiplication
+//
+// All matrices are row-major with an explicit leading dimension (row stride),
+// so sub-matrices can be passed without copying.
+
+#ifndef GEMM_H
+#define GEMM_H
+
+// Micro-kernel: C[mr x nr] += Ap * Bp, where Ap holds kc groups of mr values
+// (a packed column slice of A) and Bp holds kc groups of nr values (a packed
+// row slice of B)
+typedef void (*gemm_ukernel_fn)(int kc, const double *Ap, const double *Bp, double *C, int ldc);
+
+typedef struct {
+    const char *name;
+    int mr, nr;               // register tile shape
+    gemm_ukernel_fn fn;
+    int (*supported)(void);   // runtime CPU check, NULL = always available
+} gemm_kernel;
+
+// Every micro-kernel compiled into this binary, in order of preference (best last)
+int gemm_kernel_count(void);
+const gemm_kernel *gemm_kernel_get(int i);
+int gemm_kernel_supported(const gemm_kernel *k);
+
+// Fastest kernel the running CPU supports, or the one named by $GEMM_KERNEL
+const gemm_kernel *gemm_kernel_best(void);
+
+// C[M x N] += A[M x K] * B[K x N], parallelized over the current OpenMP team size
+void gemm_blocked(int M, int N, int K,
+                  const double *A, int lda,
+                  const double *B, int ldb,
+                  double *C, int ldc);
+
+// Same as gemm_blocked with an explicit micro-kernel
+void gemm_blocked_kernel(const gemm_kernel *k, int M, int N, int K,
+                         const double *A, int lda,
+                         const double *B, int ldb,
+                         double *C, int ldc);
+
+// Single-threaded blocked multiply, safe to call from inside OpenMP tasks
+void gemm_serial_kernel(const gemm_kernel *k, int M, int N, int K,
+                        const double *A, int lda,
+                        const double *B, int ldb,
+                        double *C, int ldc);
+
+// Recursive divide-and-conquer multiply on OpenMP tasks (gemm_tasks.c).
+// Splits the largest of M, N, K in half until every dimension is at most
+// cutoff, then runs gemm_serial_kernel on the block. With strassen_min > 0,
+// blocks whose dimensions are all at least strassen_min are split with
+// Strassen's 7-multiplication scheme instead (odd edges are peeled off first).
+void gemm_recursive(int M, int N, int K,
+                    const double *A, int lda,
+                    const double *B, int ldb,
+                    double *C, int ldc,
+                    int cutoff, int strassen_min);
+
+// Reference triple loop, same contract as gemm_blocked (used for checking)
+void gemm_naive(int M, int N, int K,
+                const double *A, int lda,
+                const double *B, int ldb,
+                double *C, int ldc);
+
+#endif
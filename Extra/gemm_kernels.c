@@ -0,0 +1,173 @@
+// GEMM micro-kernels and runtime CPU dispatch
+//
+// Every x86 kernel is compiled with a per-function target attribute instead of
+// -mavx2/-mavx512f on the command line, so one binary carries all of them and
+// picks at run time (CPUID via __builtin_cpu_supports, which also checks that
+// the OS saves the wider register state).
+//
+//   generic   4x8   plain C, whatever the compiler makes of it
+//   sse2      4x4   2-wide mul + add (SSE2 has no FMA)
+//   avx2      6x8   4-wide FMA, 12 ymm accumulators
+//   avx512    8x16  8-wide FMA, 16 zmm accumulators
+
+#include "gemm.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define GEMM_X86 1
+#include <immintrin.h>
+#endif
+
+// C[4 x 8] += Ap * Bp
+static void kernel_generic_4x8(int kc, const double *Ap, const double *Bp, double *C, int ldc) {
+    double c[4][8] = {{0.0}};
+
+    for (int p = 0; p < kc; p++) {
+        const double *a = Ap + p * 4;
+        const double *b = Bp + p * 8;
+        for (int i = 0; i < 4; i++)
+            for (int j = 0; j < 8; j++)
+                c[i][j] += a[i] * b[j];
+    }
+
+    for (int i = 0; i < 4; i++)
+        for (int j = 0; j < 8; j++)
+            C[i * ldc + j] += c[i][j];
+}
+
+#ifdef GEMM_X86
+
+// C[4 x 4] += Ap * Bp, two xmm registers per row of C
+__attribute__((target("sse2"))) static void kernel_sse2_4x4(int kc, const double *Ap, const double *Bp, double *C, int ldc) {
+    __m128d c00 = _mm_setzero_pd(), c01 = _mm_setzero_pd();
+    __m128d c10 = _mm_setzero_pd(), c11 = _mm_setzero_pd();
+    __m128d c20 = _mm_setzero_pd(), c21 = _mm_setzero_pd();
+    __m128d c30 = _mm_setzero_pd(), c31 = _mm_setzero_pd();
+
+    for (int p = 0; p < kc; p++) {
+        __m128d b0 = _mm_load_pd(Bp + p * 4);
+        __m128d b1 = _mm_load_pd(Bp + p * 4 + 2);
+        __m128d a;
+
+        a = _mm_load1_pd(Ap + p * 4 + 0);
+        c00 = _mm_add_pd(c00, _mm_mul_pd(a, b0));
+        c01 = _mm_add_pd(c01, _mm_mul_pd(a, b1));
+        a = _mm_load1_pd(Ap + p * 4 + 1);
+        c10 = _mm_add_pd(c10, _mm_mul_pd(a, b0));
+        c11 = _mm_add_pd(c11, _mm_mul_pd(a, b1));
+        a = _mm_load1_pd(Ap + p * 4 + 2);
+        c20 = _mm_add_pd(c20, _mm_mul_pd(a, b0));
+        c21 = _mm_add_pd(c21, _mm_mul_pd(a, b1));
+        a = _mm_load1_pd(Ap + p * 4 + 3);
+        c30 = _mm_add_pd(c30, _mm_mul_pd(a, b0));
+        c31 = _mm_add_pd(c31, _mm_mul_pd(a, b1));
+    }
+
+#define SSE2_STORE_ROW(i, lo, hi)                                                   \
+    do {                                                                            \
+        double *row = C + (i) * ldc;                                                \
+        _mm_storeu_pd(row, _mm_add_pd(_mm_loadu_pd(row), lo));                      \
+        _mm_storeu_pd(row + 2, _mm_add_pd(_mm_loadu_pd(row + 2), hi));              \
+    } while (0)
+    SSE2_STORE_ROW(0, c00, c01);
+    SSE2_STORE_ROW(1, c10, c11);
+    SSE2_STORE_ROW(2, c20, c21);
+    SSE2_STORE_ROW(3, c30, c31);
+#undef SSE2_STORE_ROW
+}
+
+// C[6 x 8] += Ap * Bp, two ymm registers per row of C
+__attribute__((target("avx2,fma"))) static void kernel_avx2_6x8(int kc, const double *Ap, const double *Bp, double *C, int ldc) {
+    __m256d c[6][2];
+    for (int i = 0; i < 6; i++) c[i][0] = c[i][1] = _mm256_setzero_pd();
+
+    for (int p = 0; p < kc; p++) {
+        __m256d b0 = _mm256_load_pd(Bp + p * 8);
+        __m256d b1 = _mm256_load_pd(Bp + p * 8 + 4);
+        const double *a = Ap + p * 6;
+        for (int i = 0; i < 6; i++) {
+            __m256d ai = _mm256_broadcast_sd(a + i);
+            c[i][0] = _mm256_fmadd_pd(ai, b0, c[i][0]);
+            c[i][1] = _mm256_fmadd_pd(ai, b1, c[i][1]);
+        }
+    }
+
+    for (int i = 0; i < 6; i++) {
+        double *row = C + i * ldc;
+        _mm256_storeu_pd(row, _mm256_add_pd(_mm256_loadu_pd(row), c[i][0]));
+        _mm256_storeu_pd(row + 4, _mm256_add_pd(_mm256_loadu_pd(row + 4), c[i][1]));
+    }
+}
+
+// C[8 x 16] += Ap * Bp, two zmm registers per row of C
+__attribute__((target("avx512f"))) static void kernel_avx512_8x16(int kc, const double *Ap, const double *Bp, double *C, int ldc) {
+    __m512d c[8][2];
+    for (int i = 0; i < 8; i++) c[i][0] = c[i][1] = _mm512_setzero_pd();
+
+    for (int p = 0; p < kc; p++) {
+        __m512d b0 = _mm512_load_pd(Bp + p * 16);
+        __m512d b1 = _mm512_load_pd(Bp + p * 16 + 8);
+        const double *a = Ap + p * 8;
+        for (int i = 0; i < 8; i++) {
+            __m512d ai = _mm512_set1_pd(a[i]);
+            c[i][0] = _mm512_fmadd_pd(ai, b0, c[i][0]);
+            c[i][1] = _mm512_fmadd_pd(ai, b1, c[i][1]);
+        }
+    }
+
+    for (int i = 0; i < 8; i++) {
+        double *row = C + i * ldc;
+        _mm512_storeu_pd(row, _mm512_add_pd(_mm512_loadu_pd(row), c[i][0]));
+        _mm512_storeu_pd(row + 8, _mm512_add_pd(_mm512_loadu_pd(row + 8), c[i][1]));
+    }
+}
+
+static int have_sse2(void) { return __builtin_cpu_supports("sse2"); }
+static int have_avx2(void) { return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"); }
+static int have_avx512(void) { return __builtin_cpu_supports("avx512f"); }
+
+#endif // GEMM_X86
+
+static const gemm_kernel kernels[] = {
+    {"generic", 4, 8, kernel_generic_4x8, NULL},
+#ifdef GEMM_X86
+    {"sse2", 4, 4, kernel_sse2_4x4, have_sse2},
+    {"avx2", 6, 8, kernel_avx2_6x8, have_avx2},
+    {"avx512", 8, 16, kernel_avx512_8x16, have_avx512},
+#endif
+};
+
+#define NUM_KERNELS ((int)(sizeof(kernels) / sizeof(kernels[0])))
+
+int gemm_kernel_count(void) { return NUM_KERNELS; }
+
+const gemm_kernel *gemm_kernel_get(int i) {
+    return (i >= 0 && i < NUM_KERNELS) ? &kernels[i] : NULL;
+}
+
+int gemm_kernel_supported(const gemm_kernel *k) {
+    return k->supported == NULL || k->supported();
+}
+
+const gemm_kernel *gemm_kernel_best(void) {
+    static const gemm_kernel *best = NULL;
+    if (best) return best;
+
+    // $GEMM_KERNEL forces a variant, ignored if this CPU can't run it
+    const char *forced = getenv("GEMM_KERNEL");
+    const gemm_kernel *pick = &kernels[0];
+    for (int i = 0; i < NUM_KERNELS; i++) {
+        if (!gemm_kernel_supported(&kernels[i])) continue;
+        if (forced && strcmp(forced, kernels[i].name) == 0) {
+            pick = &kernels[i];
+            break;
+        }
+        pick = &kernels[i];
+    }
+
+    // Benign race: every thread computes the same answer
+    best = pick;
+    return best;
+}
@@ -0,0 +1,173 @@
+// Recursive task-parallel matrix multiplication (divide and conquer + Strassen)
+//
+// Same pattern as fib() in Day3/fibonacci_task_recursion.c: split the problem,
+// spawn one task per half, taskwait, and stop splitting below a cutoff where
+// the serial blocked kernel from gemm.c takes over. Splitting always halves
+// the largest dimension, so sizes don't need to be powers of two.
+
+#include "gemm.h"
+
+#include <omp.h>
+#include <stdlib.h>
+
+typedef struct {
+    int cutoff;
+    int strassen_min;
+    const gemm_kernel *kernel;
+} rec_params;
+
+static void rec_multiply(const rec_params *rp, int M, int N, int K,
+                         const double *A, int lda,
+                         const double *B, int ldb,
+                         double *C, int ldc);
+
+// Z = X + sign * Y, or a plain copy of X when Y is NULL
+static void add_blocks(int rows, int cols, const double *X, int ldx,
+                       const double *Y, int ldy, double sign, double *Z, int ldz) {
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < cols; j++)
+            Z[(size_t)i * ldz + j] = X[(size_t)i * ldx + j] + (Y ? sign * Y[(size_t)i * ldy + j] : 0.0);
+}
+
+// One Strassen operand: X1 (+/- X2), where X2 may be absent
+typedef struct {
+    int first, second; // quadrant indices 0..3 (11, 12, 21, 22), second = -1 for none
+    double sign;
+} strassen_operand;
+
+// The seven products M1..M7 as (A operand, B operand)
+static const strassen_operand strassen_a[7] = {
+    {0, 3, 1.0}, {2, 3, 1.0}, {0, -1, 0.0}, {3, -1, 0.0}, {0, 1, 1.0}, {2, 0, -1.0}, {1, 3, -1.0}};
+static const strassen_operand strassen_b[7] = {
+    {0, 3, 1.0}, {0, -1, 0.0}, {1, 3, -1.0}, {2, 0, -1.0}, {3, -1, 0.0}, {0, 1, 1.0}, {2, 3, 1.0}};
+
+// How each quadrant of C is assembled from M1..M7
+static const double strassen_combine[4][7] = {
+    {1, 0, 0, 1, -1, 0, 1}, // C11 += M1 + M4 - M5 + M7
+    {0, 0, 1, 0, 1, 0, 0},  // C12 += M3 + M5
+    {0, 1, 0, 1, 0, 0, 0},  // C21 += M2 + M4
+    {1, -1, 1, 0, 0, 1, 0}, // C22 += M1 - M2 + M3 + M6
+};
+
+// Materialize one operand into a contiguous rows x cols buffer
+static double *strassen_operand_block(const strassen_operand *op, const double *quad[4], int ld,
+                                      int rows, int cols) {
+    double *Z = malloc((size_t)rows * cols * sizeof(double));
+    if (!Z) abort();
+    add_blocks(rows, cols, quad[op->first], ld,
+               op->second >= 0 ? quad[op->second] : NULL, ld, op->sign, Z, cols);
+    return Z;
+}
+
+// C[M x N] += A[M x K] * B[K x N] with M, N, K all even
+static void strassen(const rec_params *rp, int M, int N, int K,
+                     const double *A, int lda,
+                     const double *B, int ldb,
+                     double *C, int ldc) {
+    int m = M / 2, n = N / 2, k = K / 2;
+    const double *Aq[4] = {A, A + k, A + (size_t)m * lda, A + (size_t)m * lda + k};
+    const double *Bq[4] = {B, B + n, B + (size_t)k * ldb, B + (size_t)k * ldb + n};
+    double *Cq[4] = {C, C + n, C + (size_t)m * ldc, C + (size_t)m * ldc + n};
+    double *P[7];
+
+    for (int p = 0; p < 7; p++) {
+        P[p] = calloc((size_t)m * n, sizeof(double));
+        if (!P[p]) abort();
+    }
+
+    for (int p = 0; p < 7; p++) {
+#pragma omp task firstprivate(p) shared(Aq, Bq, P)
+        {
+            double *X = strassen_operand_block(&strassen_a[p], Aq, lda, m, k);
+            double *Y = strassen_operand_block(&strassen_b[p], Bq, ldb, k, n);
+            rec_multiply(rp, m, n, k, X, k, Y, n, P[p], n);
+            free(X);
+            free(Y);
+        }
+    }
+#pragma omp taskwait
+
+    for (int q = 0; q < 4; q++) {
+#pragma omp task firstprivate(q) shared(Cq, P)
+        for (int p = 0; p < 7; p++) {
+            double coef = strassen_combine[q][p];
+            if (coef == 0.0) continue;
+            for (int i = 0; i < m; i++)
+                for (int j = 0; j < n; j++)
+                    Cq[q][(size_t)i * ldc + j] += coef * P[p][(size_t)i * n + j];
+        }
+    }
+#pragma omp taskwait
+
+    for (int p = 0; p < 7; p++) free(P[p]);
+}
+
+static void rec_multiply(const rec_params *rp, int M, int N, int K,
+                         const double *A, int lda,
+                         const double *B, int ldb,
+                         double *C, int ldc) {
+    if (M <= 0 || N <= 0 || K <= 0) return;
+
+    // Base case: small enough for one thread and its caches
+    if (M <= rp->cutoff && N <= rp->cutoff && K <= rp->cutoff) {
+        gemm_serial_kernel(rp->kernel, M, N, K, A, lda, B, ldb, C, ldc);
+        return;
+    }
+
+    int min_dim = M < N ? (M < K ? M : K) : (N < K ? N : K);
+    if (rp->strassen_min > 0 && min_dim >= rp->strassen_min) {
+        int Me = M & ~1, Ne = N & ~1, Ke = K & ~1;
+
+        strassen(rp, Me, Ne, Ke, A, lda, B, ldb, C, ldc);
+
+        // Peel odd edges: last column of A times last row of B, then the
+        // last column and last row of C
+        if (Ke < K) rec_multiply(rp, Me, Ne, 1, A + Ke, lda, B + (size_t)Ke * ldb, ldb, C, ldc);
+        if (Ne < N) rec_multiply(rp, Me, 1, K, A, lda, B + Ne, ldb, C + Ne, ldc);
+        if (Me < M) rec_multiply(rp, 1, N, K, A + (size_t)Me * lda, lda, B, ldb, C + (size_t)Me * ldc, ldc);
+        return;
+    }
+
+    if (M >= N && M >= K) {
+        // Split rows of A and C: the halves write disjoint parts of C
+        int h = M / 2;
+
+#pragma omp task
+        rec_multiply(rp, h, N, K, A, lda, B, ldb, C, ldc);
+
+#pragma omp task
+        rec_multiply(rp, M - h, N, K, A + (size_t)h * lda, lda, B, ldb, C + (size_t)h * ldc, ldc);
+
+#pragma omp taskwait
+    } else if (N >= K) {
+        // Split columns of B and C
+        int h = N / 2;
+
+#pragma omp task
+        rec_multiply(rp, M, h, K, A, lda, B, ldb, C, ldc);
+
+#pragma omp task
+        rec_multiply(rp, M, N - h, K, A, lda, B + h, ldb, C + h, ldc);
+
+#pragma omp taskwait
+    } else {
+        // Split the inner dimension: both halves update all of C, so they run
+        // one after the other (each one is still parallel inside)
+        int h = K / 2;
+        rec_multiply(rp, M, N, h, A, lda, B, ldb, C, ldc);
+        rec_multiply(rp, M, N, K - h, A + h, lda, B + (size_t)h * ldb, ldb, C, ldc);
+    }
+}
+
+// Entry point: one team, a single thread starts the recursion
+void gemm_recursive(int M, int N, int K,
+                    const double *A, int lda,
+                    const double *B, int ldb,
+                    double *C, int ldc,
+                    int cutoff, int strassen_min) {
+    rec_params rp = {cutoff > 0 ? cutoff : 1, strassen_min, gemm_kernel_best()};
+
+#pragma omp parallel
+#pragma omp single
+    rec_multiply(&rp, M, N, K, A, lda, B, ldb, C, ldc);
+}
@@ -1,69 +1,341 @@
-// gcc -fopenmp matmul_benchmark.c -o matmul_benchmark
+// gcc -O2 -fopenmp matmul_benchmark.c gemm.c gemm_kernels.c gemm_tasks.c -o matmul_benchmark -lm
+//
+// Usage: ./matmul_benchmark [options]
+//   --bind[=close|spread]  pin threads (sets OMP_PLACES=cores and OMP_PROC_BIND, then re-execs)
+//   --serial-init          initialize on one thread like the original version, to see
+//                          the NUMA penalty that parallel first-touch removes
+//   --size=N               benchmark only N x N (default: 10, 100, 1000)
+//   --skip-naive           leave out the triple loop (it takes minutes at 8k)
+//   --best-only            only time the auto-selected micro-kernel in the loop variant
+//   --cutoff=C             task recursion switches to the serial kernel at C (default 256)
+//   --strassen=S           Strassen on blocks of at least S (default 2048, 0 = off)
 
+#ifdef __linux__
+#define _GNU_SOURCE // sched_getcpu
+#include <sched.h>
+#endif
+
+#include <math.h>
 #include <omp.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
-// Multithreaded matrix multiplication benchmark
-int main() {
-    int proc_count = omp_get_num_procs();
+#include "gemm.h"
 
-    for (int N = 10; N <= 1000; N *= 10) {
-        double *A = malloc(N * N * sizeof(double));
-        double *B = malloc(N * N * sizeof(double));
-        double *C = malloc(N * N * sizeof(double));
+#define MAX_SOCKETS 8
 
-        if (!A || !B || !C) {
-            printf("Memory allocation failed!\n");
-            return 1;
+// Matrices at least this big (elements) also get a per-socket bandwidth report
+#define BW_MIN_ELEMS (1 << 19)
+
+#define DEFAULT_CUTOFF 256
+#define DEFAULT_STRASSEN 2048
+
+// Largest element-wise difference between two N x N matrices
+static double max_abs_diff(const double *X, const double *Y, int N) {
+    double diff = 0.0;
+    for (long i = 0; i < (long)N * N; i++) {
+        double d = fabs(X[i] - Y[i]);
+        if (d > diff) diff = d;
+    }
+    return diff;
+}
+
+static double gflops(int N, double seconds) {
+    return 2.0 * N * N * (double)N / seconds * 1e-9;
+}
+
+static void print_row(int threads, const char *variant, int N, double elapsed, double base) {
+    printf("%-10d %-15s %-15.5f %-15.2f %-15.2f\n", threads, variant,
+           elapsed, gflops(N, elapsed), base / elapsed);
+}
+
+// Socket (physical package) the given CPU belongs to, 0 if unknown
+static int cpu_socket(int cpu) {
+    int id = 0;
+#ifdef __linux__
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+    FILE *f = fopen(path, "r");
+    if (f) {
+        if (fscanf(f, "%d", &id) != 1) id = 0;
+        fclose(f);
+    }
+#else
+    (void)cpu;
+#endif
+    return (id >= 0 && id < MAX_SOCKETS) ? id : 0;
+}
+
+static int current_cpu(void) {
+#ifdef __linux__
+    return sched_getcpu();
+#else
+    return 0;
+#endif
+}
+
+// Thread binding has to be in the environment before the OpenMP runtime starts,
+// so --bind sets OMP_PLACES/OMP_PROC_BIND and re-executes this program
+static void apply_binding(const char *policy, char **argv) {
+    if (getenv("OMP_PLACES") && getenv("OMP_PROC_BIND")) return;
+
+    if (!getenv("OMP_PLACES")) setenv("OMP_PLACES", "cores", 1);
+    if (!getenv("OMP_PROC_BIND")) setenv("OMP_PROC_BIND", policy, 1);
+    execvp(argv[0], argv);
+    perror("execvp"); // only reached if re-exec failed, carry on unbound
+}
+
+static const char *proc_bind_name(omp_proc_bind_t bind) {
+    switch (bind) {
+    case omp_proc_bind_false: return "false";
+    case omp_proc_bind_true: return "true";
+    case omp_proc_bind_close: return "close";
+    case omp_proc_bind_spread: return "spread";
+    default: return "primary";
+    }
+}
+
+// Initialize matrices with the same static row partition the compute loops use,
+// so each page is first touched (and therefore placed) on the NUMA node of the
+// thread that will later work on it. The values depend on the position, so a
+// variant that mixes up rows, columns or quadrants gets a different C; they
+// are small integers, so every correct variant gets exactly the same C.
+static void init_matrices(int N, double *A, double *B, double *C, int parallel) {
+#pragma omp parallel for collapse(2) schedule(static) if (parallel)
+    for (int i = 0; i < N; i++)
+        for (int j = 0; j < N; j++) {
+            A[i * N + j] = (double)((i * 7 + j * 3) % 11);
+            B[i * N + j] = (double)((i * 5 + j * 2) % 13);
+            C[i * N + j] = 0.0;
         }
+}
+
+// Compare a result with the reference of its size, or make it the reference
+// if there is none yet
+static int keep_reference(double **ref, const double *C, int N, double *worst_diff) {
+    if (!*ref) {
+        *ref = malloc(N * N * sizeof(double));
+        if (!*ref) return -1;
+        memcpy(*ref, C, N * N * sizeof(double));
+        return 0;
+    }
+    double diff = max_abs_diff(*ref, C, N);
+    if (diff > *worst_diff) *worst_diff = diff;
+    return 0;
+}
+
+// Every thread streams through its own slice of A, B and C (same schedule as
+// the initialization) and the read bandwidth is summed per socket
+static void socket_bandwidth_report(int N, const double *A, const double *B, const double *C) {
+    double bytes[MAX_SOCKETS] = {0};
+    double seconds[MAX_SOCKETS] = {0};
+    int threads_on[MAX_SOCKETS] = {0};
+    double checksum = 0.0;
+
+#pragma omp parallel reduction(+ : checksum)
+    {
+        int socket = cpu_socket(current_cpu());
+        long count = 0;
+        double sum = 0.0;
 
-        // Initialize matrices
+#pragma omp barrier
+        double start = omp_get_wtime();
+#pragma omp for collapse(2) schedule(static) nowait
         for (int i = 0; i < N; i++)
             for (int j = 0; j < N; j++) {
-                A[i * N + j] = 1.0;
-                B[i * N + j] = 2.0;
-                C[i * N + j] = 0.0;
+                sum += A[i * N + j] + B[i * N + j] + C[i * N + j];
+                count++;
             }
+        double elapsed = omp_get_wtime() - start;
+        checksum += sum;
 
-        double base_time = 0.0;
+        // A socket is only as fast as its slowest thread
+#pragma omp critical
+        {
+            bytes[socket] += 3.0 * sizeof(double) * count;
+            if (elapsed > seconds[socket]) seconds[socket] = elapsed;
+            threads_on[socket]++;
+        }
+    }
+
+    for (int s = 0; s < MAX_SOCKETS; s++) {
+        if (threads_on[s] == 0) continue;
+        printf("           socket %d: %2d threads, %8.2f GB/s\n",
+               s, threads_on[s], bytes[s] / seconds[s] * 1e-9);
+    }
+    if (checksum < 0.0) printf("(checksum %f)\n", checksum); // keeps the reads alive
+}
+
+// Multithreaded matrix multiplication benchmark
+// Times the naive triple loop side by side with the blocked GEMM from gemm.c,
+// once per micro-kernel the CPU supports
+int main(int argc, char **argv) {
+    int serial_init = 0;
+    int only_size = 0;
+    int skip_naive = 0;
+    int best_only = 0;
+    int cutoff = DEFAULT_CUTOFF;
+    int strassen_min = DEFAULT_STRASSEN;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bind") == 0) {
+            apply_binding("close", argv);
+        } else if (strncmp(argv[i], "--bind=", 7) == 0) {
+            apply_binding(argv[i] + 7, argv);
+        } else if (strcmp(argv[i], "--serial-init") == 0) {
+            serial_init = 1;
+        } else if (strncmp(argv[i], "--size=", 7) == 0) {
+            only_size = atoi(argv[i] + 7);
+        } else if (strcmp(argv[i], "--skip-naive") == 0) {
+            skip_naive = 1;
+        } else if (strcmp(argv[i], "--best-only") == 0) {
+            best_only = 1;
+        } else if (strncmp(argv[i], "--cutoff=", 9) == 0) {
+            cutoff = atoi(argv[i] + 9);
+        } else if (strncmp(argv[i], "--strassen=", 11) == 0) {
+            strassen_min = atoi(argv[i] + 11);
+        } else {
+            printf("usage: %s [--bind[=close|spread]] [--serial-init] [--size=N] [--skip-naive]\n"
+                   "       [--best-only] [--cutoff=C] [--strassen=S]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    int proc_count = omp_get_num_procs();
+    int kernel_count = gemm_kernel_count();
+    const gemm_kernel *best = gemm_kernel_best();
+
+    printf("Micro-kernels:");
+    for (int v = 0; v < kernel_count; v++) {
+        const gemm_kernel *k = gemm_kernel_get(v);
+        printf(" %s(%dx%d)%s", k->name, k->mr, k->nr,
+               !gemm_kernel_supported(k) ? "[unsupported]" : (k == best ? "[auto]" : ""));
+    }
+    printf("\n");
+    printf("Binding: %s, places: %d, init: %s\n", proc_bind_name(omp_get_proc_bind()),
+           omp_get_num_places(), serial_init ? "serial" : "parallel first-touch");
+    printf("Tasks: cutoff %d, Strassen %s", cutoff, strassen_min > 0 ? "from " : "off");
+    if (strassen_min > 0) printf("%d", strassen_min);
+    printf("\n\n");
+
+    for (int N = only_size > 0 ? only_size : 10; N <= (only_size > 0 ? only_size : 1000); N *= 10) {
+        // Single-thread time of every variant: the naive loop, each blocked
+        // kernel, then the two recursive task variants
+        double base_time[3 + kernel_count];
+        // First result of this size (the naive loop, or without it the first
+        // variant); every later run, at every team size, is compared with it
+        double *ref = NULL;
+        double worst_diff = 0.0;
 
         printf("Benchmarking matrix multiplication (size %d x %d)\n", N, N);
-        printf("%-10s %-15s %-15s\n", "Threads", "Time (s)", "Speedup");
+        printf("%-10s %-15s %-15s %-15s %-15s\n", "Threads", "Variant", "Time (s)", "GFLOP/s", "Speedup");
 
         for (int threads = 1; threads <= proc_count; threads *= 2) {
             omp_set_num_threads(threads);
 
-            double start = omp_get_wtime();
+            // Fresh allocations for every team size so first-touch placement
+            // matches the threads that are about to use the data
+            double *A = malloc(N * N * sizeof(double));
+            double *B = malloc(N * N * sizeof(double));
+            double *C = malloc(N * N * sizeof(double));
+            double *C_blk = malloc(N * N * sizeof(double));
+
+            if (!A || !B || !C || !C_blk) {
+                printf("Memory allocation failed!\n");
+                return 1;
+            }
 
-#pragma omp parallel for collapse(2)
-            for (int i = 0; i < N; i++) {
-                for (int j = 0; j < N; j++) {
-                    double sum = 0.0;
-                    for (int k = 0; k < N; k++) {
-                        sum += A[i * N + k] * B[k * N + j];
+            init_matrices(N, A, B, C, !serial_init);
+            init_matrices(N, A, B, C_blk, !serial_init);
+
+            double start, end, elapsed;
+
+            if (!skip_naive) {
+                start = omp_get_wtime();
+
+#pragma omp parallel for collapse(2) schedule(static)
+                for (int i = 0; i < N; i++) {
+                    for (int j = 0; j < N; j++) {
+                        double sum = 0.0;
+                        for (int k = 0; k < N; k++) {
+                            sum += A[i * N + k] * B[k * N + j];
+                        }
+                        C[i * N + j] = sum;
                     }
-                    C[i * N + j] = sum;
+                }
+
+                end = omp_get_wtime();
+                elapsed = end - start;
+
+                if (threads == 1) {
+                    base_time[0] = elapsed;
+                }
+
+                print_row(threads, "naive", N, elapsed, base_time[0]);
+
+                if (keep_reference(&ref, C, N, &worst_diff) < 0) {
+                    printf("Memory allocation failed!\n");
+                    return 1;
                 }
             }
 
-            double end = omp_get_wtime();
-            double elapsed = end - start;
+            for (int v = 0; v < kernel_count + 2; v++) {
+                const gemm_kernel *k = gemm_kernel_get(v);
+                const char *name;
+
+                if (k) {
+                    if (!gemm_kernel_supported(k) || (best_only && k != best)) continue;
+                    name = k->name;
+                } else if (v == kernel_count) {
+                    name = "tasks";
+                } else {
+                    if (strassen_min <= 0) continue;
+                    name = "strassen";
+                }
+
+                // All GEMM variants accumulate into C, so start from zero every run
+                memset(C_blk, 0, N * N * sizeof(double));
+
+                start = omp_get_wtime();
+                if (k)
+                    gemm_blocked_kernel(k, N, N, N, A, N, B, N, C_blk, N);
+                else
+                    gemm_recursive(N, N, N, A, N, B, N, C_blk, N, cutoff,
+                                   v == kernel_count + 1 ? strassen_min : 0);
+                end = omp_get_wtime();
+                elapsed = end - start;
 
-            if (threads == 1) {
-                base_time = elapsed;
+                if (threads == 1) {
+                    base_time[1 + v] = elapsed;
+                }
+
+                if (keep_reference(&ref, C_blk, N, &worst_diff) < 0) {
+                    printf("Memory allocation failed!\n");
+                    return 1;
+                }
+
+                print_row(threads, name, N, elapsed, base_time[1 + v]);
             }
 
-            printf("%-10d %-15.5f %-15.2f\n", threads, elapsed, base_time / elapsed);
+            if ((long)N * N >= BW_MIN_ELEMS) {
+                socket_bandwidth_report(N, A, B, C);
+            }
+
+            // Free memory
+            free(A);
+            free(B);
+            free(C);
+            free(C_blk);
         }
 
-        printf("Check: C[0][0] = %.2f, C[N-1][N-1] = %.2f\n", C[0], C[(N - 1) * N + (N - 1)]);
+        if (ref) {
+            printf("Check: C[0][0] = %.2f, C[N-1][N-1] = %.2f, max |reference - variant| = %.2e\n",
+                   ref[0], ref[(N - 1) * N + (N - 1)], worst_diff);
+            free(ref);
+        }
         printf("\n");
-
-        // Free memory
-        free(A);
-        free(B);
-        free(C);
     }
     return 0;
 }